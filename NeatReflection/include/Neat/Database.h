@@ -0,0 +1,157 @@
+#pragma once
+#include "Neat/DllMacro.h"
+#include "Neat/TemplateTypeId.h"
+#include "Neat/Reflection.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+
+// Interface
+// ===========================================================================
+
+namespace Neat
+{
+	// The on-disk layout of a reflection database: the reflected types of one module, as written by
+	// `NeatReflectionCodeGen --database`. It's position independent, records refer to each other by index and to
+	// strings by offset, so the file can be memory mapped and read in place. Types are identified by `StableTypeId`,
+	// so it can be used without linking the generated code. Everything is in the native byte order.
+	namespace DatabaseFormat
+	{
+		constexpr std::array<char, 8> magic = { 'N', 'E', 'A', 'T', 'R', 'D', 'B', '\0' };
+		constexpr uint32_t version = 2;
+		constexpr size_t table_alignment = 8; // Of every table's offset, so the records can be read in place
+
+		struct String
+		{
+			uint32_t offset; // Into the string table
+			uint32_t size;
+		};
+
+		struct Range
+		{
+			uint32_t first; // Index into the table of the records
+			uint32_t count;
+		};
+
+		struct Table
+		{
+			uint32_t offset; // From the start of the file
+			uint32_t count; // Of records, or bytes for the string table
+		};
+
+		enum class TypeKind : uint32_t
+		{
+			Class, // Or struct
+			Enum
+		};
+
+		struct TypeRecord
+		{
+			StableTypeId id;
+			String name;
+			TypeKind kind;
+			Range bases; // Empty for enums
+			Range fields;
+			Range methods;
+			Range enumerators; // Empty for classes
+		};
+
+		struct BaseRecord
+		{
+			StableTypeId id;
+			String name;
+			Access access;
+		};
+
+		struct FieldRecord
+		{
+			StableTypeId type;
+			String name;
+			String type_name;
+			Access access;
+		};
+
+		struct MethodRecord
+		{
+			StableTypeId return_type;
+			String name;
+			String return_type_name;
+			Range arguments;
+			Access access;
+		};
+
+		struct ArgumentRecord
+		{
+			StableTypeId type;
+			String type_name;
+		};
+
+		struct EnumeratorRecord
+		{
+			int64_t value; // Unsigned values above INT64_MAX wrap around, like `Enumerator::value`
+			String name;
+		};
+
+		struct alignas(table_alignment) Header
+		{
+			std::array<char, 8> magic;
+			uint32_t version;
+			uint32_t file_size;
+			String module_name;
+			Table types; // Sorted by id
+			Table bases;
+			Table fields;
+			Table methods;
+			Table arguments;
+			Table enumerators; // In the order they're declared
+			Table strings;
+		};
+	}
+
+	// Reads a reflection database in place. Nothing is copied, so the data needs to stay valid (mapped) while the
+	// database is used. Everything is validated once by `open`, afterwards no accessor can read out of bounds.
+	class Database
+	{
+	public:
+		using TypeRecord = DatabaseFormat::TypeRecord;
+		using BaseRecord = DatabaseFormat::BaseRecord;
+		using FieldRecord = DatabaseFormat::FieldRecord;
+		using MethodRecord = DatabaseFormat::MethodRecord;
+		using ArgumentRecord = DatabaseFormat::ArgumentRecord;
+		using EnumeratorRecord = DatabaseFormat::EnumeratorRecord;
+
+		// Modifiers
+		// Returns false when `data` isn't a database of this version, or is corrupt. `data` needs to be aligned
+		// to `DatabaseFormat::table_alignment`, which memory mapped files always are.
+		REFL_API bool open(std::span<const std::byte> data);
+
+		// Accessors
+		bool is_open() const { return header != nullptr; }
+		std::string_view get_module_name() const { return get_string(header->module_name); }
+
+		std::span<const TypeRecord> get_types() const { return types; } // Sorted by id
+		REFL_API const TypeRecord* find_type(StableTypeId id) const; // Returns nullptr when the type isn't found
+		const TypeRecord* find_type(std::string_view qualified_name) const { return find_type(get_stable_type_id(qualified_name)); }
+
+		std::span<const BaseRecord> get_bases(const TypeRecord& type) const { return bases.subspan(type.bases.first, type.bases.count); }
+		std::span<const FieldRecord> get_fields(const TypeRecord& type) const { return fields.subspan(type.fields.first, type.fields.count); }
+		std::span<const MethodRecord> get_methods(const TypeRecord& type) const { return methods.subspan(type.methods.first, type.methods.count); }
+		std::span<const ArgumentRecord> get_arguments(const MethodRecord& method) const { return arguments.subspan(method.arguments.first, method.arguments.count); }
+		std::span<const EnumeratorRecord> get_enumerators(const TypeRecord& type) const { return enumerators.subspan(type.enumerators.first, type.enumerators.count); }
+		std::string_view get_string(DatabaseFormat::String string) const { return strings.substr(string.offset, string.size); }
+
+	private:
+		const DatabaseFormat::Header* header = nullptr;
+		std::span<const TypeRecord> types;
+		std::span<const BaseRecord> bases;
+		std::span<const FieldRecord> fields;
+		std::span<const MethodRecord> methods;
+		std::span<const ArgumentRecord> arguments;
+		std::span<const EnumeratorRecord> enumerators;
+		std::string_view strings;
+	};
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "Neat/DllMacro.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+// Interface
+// ===========================================================================
+
+namespace Neat
+{
+	// With `NEAT_REFLECTION_INSTRUMENTATION` defined, the registry counts what it does, so the cost of reflection can be
+	// attributed in telemetry. Otherwise the hooks are empty and compile to nothing, and `get_statistics` returns zeroes.
+#ifdef NEAT_REFLECTION_INSTRUMENTATION
+	constexpr bool has_instrumentation = true;
+#else
+	constexpr bool has_instrumentation = false;
+#endif
+
+	struct LookupStatistics
+	{
+		// Functions
+		uint64_t get_count() const { return hits + misses; }
+		double get_hit_rate() const { return (get_count() == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(get_count())); }
+
+		// Data
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+	};
+
+	// Registering a module only links it in, its types are resolved and published on the first lookup which needs
+	// them. So that's where the time of a module's registration goes, and what's measured.
+	struct ModuleStatistics
+	{
+		std::string name; // A copy, the module could be unloaded with its DLL
+		size_t type_count = 0;
+		std::chrono::nanoseconds resolve_time{};
+		uint64_t allocated_bytes = 0; // By the registry, when its tables had to grow
+	};
+
+	struct Statistics
+	{
+		uint64_t added_type_count = 0; // Calls of `add_type`
+		uint64_t added_type_bytes = 0; // Allocated by the registry for them: the types themselves and growing its tables
+		LookupStatistics lookups_by_name; // `get_type(std::string_view)`
+		LookupStatistics lookups_by_id; // `get_type(TemplateTypeId)` and `get_type<T>()`
+		std::vector<ModuleStatistics> modules; // In the order they were resolved
+	};
+
+	// Thread safe. Both do nothing without `NEAT_REFLECTION_INSTRUMENTATION`.
+	REFL_API Statistics get_statistics();
+	REFL_API void reset_statistics();
+}
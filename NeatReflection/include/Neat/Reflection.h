@@ -3,14 +3,18 @@
 #include "Neat/TemplateTypeId.h"
 #include "Neat/ReflectPrivateMembers.h"
 
+#include <algorithm>
 #include <any>
-#include <string>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string_view>
 #include <utility>
-#include <vector>
 #include <type_traits>
 #include <span>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 
 // Forward Declarations
@@ -20,6 +24,12 @@ namespace Neat
 	struct Field;
 	struct Method;
 	struct BaseClass;
+	struct Inheritance;
+	struct MemberIndex;
+	struct Enum;
+	struct Enumerator;
+	struct Module;
+	struct ModuleHandle;
 }
 
 
@@ -28,82 +38,339 @@ namespace Neat
 	// Functions
 	// ===========================================================================
 
-	REFL_API Type& add_type(Type&&);
+	// All functions are thread safe. Lookups of types which were added already never lock, and the returned 
+	// types stay at the same address forever, so pointers to them can be cached.
 
-	REFL_API std::span<Type> get_types();
+	// The type's bases, fields and methods aren't copied, they need to outlive the registration.
+	REFL_API Type& add_type(Type&&);
+	// Only links the module in. Its types are resolved and added when one of them is first looked up, so modules
+	// of which nothing is queried cost nothing. The module needs to outlive the registration, generated modules are static tables.
+	// Adding a module which is registered already does nothing, and returns the handle of that registration.
+	REFL_API ModuleHandle add_module(Module& module);
+	// Removes the types of the module again, in O(types in module), so a reloaded DLL doesn't leave stale types behind. 
+	// Pointers to its types must not be used afterwards. Returns false when the handle is stale.
+	REFL_API bool remove_module(ModuleHandle handle);
+	REFL_API bool is_registered(ModuleHandle handle);
+
+	// In the order they were added. Types added later aren't part of the returned span, it can be kept around until a
+	// module is removed.
+	REFL_API std::span<Type* const> get_types();
 	REFL_API Type* get_type(std::string_view type_name);
 	REFL_API Type* get_type(TemplateTypeId type_id);
 	template<typename T>
 	Type* get_type() { return get_type(get_id<T>()); }
 
+	// Copying and moving through `Type` has to be enabled per type. `std::is_copy_constructible` is also true for types
+	// which can't be copied, like a struct with a `std::vector<std::unique_ptr<T>>`, whose copy constructor then fails to
+	// compile. Return false when `T` isn't registered. A module added again after it was removed needs them again.
+	template<typename T>
+	bool enable_copy_construction();
+	template<typename T>
+	bool enable_move_construction();
+
 
 	// Types
 	// ===========================================================================
 
 	enum class Access : uint8_t { Public, Protected, Private };
 
+	// Every type has a `create` function which can be used in a constant expression, so reflection data can be 
+	// emitted as `constinit` tables. Data only known at runtime (type ids, offsets) is filled in by `resolve`
+	// when the type is added to the registry. Stable type ids (`NEAT_REFLECTION_STABLE_TYPE_IDS`) are known up front.
+
 	struct Type
 	{
-		std::string name;
-		TemplateTypeId id;
-		std::vector<BaseClass> bases;
-		std::vector<Field> fields;
-		std::vector<Method> methods;
+		// Functions
+		template<typename T>
+		static constexpr Type create(std::string_view name, std::span<BaseClass> bases, std::span<Field> fields, std::span<Method> methods);
+		template<typename TEnum>
+		static constexpr Type create(std::string_view name, Enum& enumeration);
+
+		using ResolveFunction = void (*)(Type& type);
+		using ConstructFunction = void (*)(void* objects, size_t count);
+		using CopyFunction = void (*)(void* objects, const void* sources, size_t count);
+		using MoveFunction = void (*)(void* objects, void* sources, size_t count);
+		using DestroyFunction = void (*)(void* objects, size_t count);
+
+		// Lifetime
+		// Constructs `count` objects back to back (`size` bytes apart) in uninitialised storage aligned to `alignment`,
+		// so pools and arenas can create reflected objects without a heap allocation each. Objects are value
+		// initialised (`T()`), copied or moved from `count` objects at `sources`. When a constructor throws, the objects
+		// constructed so far are destroyed again. All of them return false when the type can't be constructed that way,
+		// copying and moving only work once enabled by `enable_copy_construction` and `enable_move_construction`.
+		bool default_construct(void* objects, size_t count = 1) const;
+		bool copy_construct(void* objects, const void* sources, size_t count = 1) const;
+		bool move_construct(void* objects, void* sources, size_t count = 1) const;
+		bool destroy(void* objects, size_t count = 1) const;
 
-		auto operator<=>(const Type& other) const noexcept = default;
+		// Data
+		std::string_view name;
+		TemplateTypeId id;
+		std::span<BaseClass> bases;
+		std::span<Field> fields;
+		std::span<Method> methods;
+
+		uint32_t size = 0; // 0 for types which aren't C++ types
+		uint16_t alignment = 0;
+		ConstructFunction default_constructor = nullptr; // Untyped versions of the lifetime functions, nullptr when
+		mutable CopyFunction copy_constructor = nullptr; // the type doesn't have an accessible one (or it isn't enabled)
+		mutable MoveFunction move_constructor = nullptr;
+		DestroyFunction destructor = nullptr;
+
+		// Computed by `add_type`. True when every field is trivially copyable and the fields are laid out back to back,
+		// so all of them can be copied with a single memcpy from the lowest field offset up to the end of the last field.
+		bool has_contiguous_trivially_copyable_fields = false;
+		Enum* enumeration = nullptr; // Only set for enums
+
+		ResolveFunction resolve = nullptr;
+
+		// Use `get_inheritance` and `get_member_index`
+		mutable const Inheritance* inheritance = nullptr;
+		mutable const MemberIndex* member_index = nullptr;
+
+		// Members
+		// Only the type's own members, inherited fields are in `get_inheritance`. The index is built on first use, 
+		// afterwards a lookup hashes the name once and usually compares a single member. Nothing is allocated.
+		// Return nullptr when there's no such member. For an overloaded method, the first declared overload is found.
+		REFL_API const MemberIndex& get_member_index() const;
+		REFL_API const Field* find_field(std::string_view name) const;
+		REFL_API const Method* find_method(std::string_view name) const;
+
+		// Inheritance
+		// Every direct and indirect base, computed on first use and cached until the module of one of them is removed.
+		// Only includes bases which are registered (resolving their modules when needed). The reference stays valid
+		// until the module of the type itself is removed.
+		REFL_API const Inheritance& get_inheritance() const;
+		bool is_derived_from(TemplateTypeId base_id) const;
+		template<typename TBase>
+		bool is_derived_from() const { return is_derived_from(get_id<TBase>()); }
+		// Returns the address of the `base_id` subobject in `object`, or nullptr when it isn't a (publicly accessible) base
+		void* upcast(void* object, TemplateTypeId base_id) const;
 	};
 
 	struct BaseClass
 	{
+		// Functions
+		template<typename TObject, typename TBase>
+		static constexpr BaseClass create(Access access);
+
+		using UpcastFunction = void* (*)(void* object);
+		using ResolveFunction = void (*)(BaseClass& base);
+
+		// Data
 		TemplateTypeId base_id;
 		Access access;
+		bool is_virtual = false; // Only reliable for publicly accessible bases
+		std::ptrdiff_t offset = 0; // Of the base subobject inside the derived object, unless it's virtual
+		UpcastFunction upcast = nullptr; // Only set when the base is publicly accessible
+
+		ResolveFunction resolve = nullptr;
+
+		// Operators
+		bool operator==(const BaseClass& other) const noexcept { return base_id == other.base_id && access == other.access; }
+	};
+
+	struct Enumerator
+	{
+		// Functions
+		template<auto Value>
+		static constexpr Enumerator create(std::string_view name);
 
-		auto operator<=>(const BaseClass& other) const noexcept = default;
+		// Data
+		std::string_view name;
+		int64_t value; // Unsigned values above INT64_MAX wrap around, they still compare equal to themselves
 	};
 
+	// Lookups in both directions are binary searches, no strings are compared linearly
+	struct Enum
+	{
+		// Functions
+		template<typename TEnum>
+		static constexpr Enum create(std::span<const Enumerator> enumerators, std::span<const Enumerator*> by_value);
+
+		using ResolveFunction = void (*)(Enum& enumeration);
+
+		// Return nullptr when there's no such enumerator. When enumerators share a value, the first by name is found.
+		const Enumerator* find(std::string_view name) const;
+		const Enumerator* find(int64_t value) const;
+
+		// Returns an empty string when `value` isn't an enumerator
+		template<typename TEnum>
+		std::string_view to_name(TEnum value) const;
+		// Returns false when there's no enumerator called `name`, `value` is left untouched then
+		template<typename TEnum>
+		bool to_value(std::string_view name, TEnum& value) const;
+
+		// Data
+		std::span<const Enumerator> enumerators; // Sorted by name
+		std::span<const Enumerator*> by_value; // The same enumerators sorted by value, filled in by `resolve`
+		TemplateTypeId underlying_type;
+
+		ResolveFunction resolve = nullptr;
+	};
+
+	// A direct or indirect base, as found in `Inheritance::bases`
+	struct InheritedBase
+	{
+		// Functions
+		void* upcast(void* object) const; // Returns the address of the base subobject inside `object`
+
+		// Data
+		TemplateTypeId base_id;
+		Access access; // The most restrictive one on the way to the base
+		bool has_fixed_offset; // False when there's a virtual base on the way, then it's upcast through `via`
+		std::ptrdiff_t offset; // Of the base subobject inside the derived object, when `has_fixed_offset`
+		const BaseClass* base; // The last step towards the base
+		const InheritedBase* via; // The base `base` belongs to, nullptr for a direct base
+	};
+
+	// A field of the type itself or of one of its bases, as found in `Inheritance::fields`
+	struct InheritedField
+	{
+		// Functions
+		void* address_of(void* object) const; // Returns the address of the field inside `object`, an object of the derived type
+
+		// Data
+		const Field* field;
+		const InheritedBase* base; // The base declaring the field, nullptr for the type's own fields
+	};
+
+	struct Inheritance
+	{
+		std::span<const InheritedBase> bases; // Sorted by `base_id`. When a base is inherited multiple times, only the nearest is kept.
+		std::span<const InheritedField> fields; // The type's own fields first, followed by those of its bases
+	};
+
+	// Open addressing tables of the type's own members by name, with linear probing. Each table is at most half full,
+	// its size is a power of two (or 0 without such members) and unused slots are nullptr.
+	struct MemberIndex
+	{
+		std::span<const Field* const> fields;
+		std::span<const Method* const> methods;
+	};
+
+	// Fields and methods only hold what's needed to find and access a member, so code going over all members of a type
+	// (a serializer for example) streams through little memory. The boxed accessors, attributes and resolve thunks are
+	// in their `Details`, a constant per member pointer. Everything else they point to is read-only data shared by the
+	// whole module: names are string literals of the generated code, methods with the same argument types share one
+	// `argument_types` array.
+
 	struct Field
 	{
 		// Functions
 		template<typename TObject, typename TType, TType TObject::* PtrToMember>
-		static Field create(std::string_view name, Access access);
+		static constexpr Field create(std::string_view name, Access access);
 
 		using GetValueFunction = std::any (*)(void* object);
 		using SetValueFunction = void (*)(void* object, std::any value);
+		using GatherFunction = void (*)(const void* objects, size_t stride, size_t count, void* values);
+		using ScatterFunction = void (*)(void* objects, size_t stride, size_t count, const void* values);
+		using AddressOfFunction = void* (*)(void* object);
+		using ResolveFunction = void (*)(Field& field);
+
+		// What's rarely needed, kept out of `Field` so iterating fields touches less memory. It only depends on the
+		// member pointer, so it's a constant shared by every field created for it.
+		struct Details
+		{
+			StableTypeId stable_type; // `get_stable_id` of the field's type, also without `NEAT_REFLECTION_STABLE_TYPE_IDS`
+			GetValueFunction get_value;
+			SetValueFunction set_value;
+			GatherFunction gather_values; // Untyped versions of `gather` and `scatter`
+			ScatterFunction scatter_values;
+			std::span<const std::string_view> attributes; // Unused currently
+			ResolveFunction resolve;
+		};
+
+		// Boxed access, through `details`
+		std::any get_value(void* object) const { return details->get_value(object); }
+		void set_value(void* object, std::any value) const { details->set_value(object, std::move(value)); }
 
-		GetValueFunction get_value;
-		SetValueFunction set_value;
+		// Typed access, without boxing in a std::any. Returns nullptr/false when `T` isn't the type of the field.
+		template<typename T>
+		T* get(void* object) const;
+		template<typename T>
+		bool set(void* object, const T& value) const;
+
+		// Batched access to the field of `count` objects which are `stride` bytes apart (`sizeof(TObject)` for an array).
+		// The values are copied to/from `values`, an array of `count` (constructed) values. It's one indirect call for
+		// all objects, and a loop the compiler can vectorise. Returns false when `T` isn't the type of the field.
+		template<typename T>
+		bool gather(const void* objects, size_t stride, size_t count, T* values) const;
+		template<typename T>
+		bool scatter(void* objects, size_t stride, size_t count, const T* values) const;
 
 		// Data
-		TemplateTypeId object_type;
+		AddressOfFunction address_of; // Returns the address of the field inside `object`
+		uint32_t offset; // Byte offset of the field inside an object of `object_type`
+		uint32_t size;
 		TemplateTypeId type;
-		std::string name;
-		std::vector<std::string> attributes; // Unused currently
+		TemplateTypeId object_type;
+		uint16_t alignment;
+		bool is_trivially_copyable;
+		bool is_pointer; // Also member pointers and arrays of them, their values mean nothing in another process
 		Access access;
-
-		// Operators
-		auto operator<=>(const Field& other) const noexcept = default;
+		std::string_view name;
+		const Details* details;
 	};
 
 	struct Method
 	{
 		// Functions
 		template<auto PtrToMemberFunction, typename TObject, typename TReturn, typename... TArgs>
-		static Method create(std::string_view name, Access access);
+		static constexpr Method create(std::string_view name, Access access);
 
 		using InvokeFunction = std::any (*)(void* object, std::span<std::any> arguments);
-		
-		InvokeFunction invoke;
+		// `arguments` points to one pointer per argument, each pointing to a value of exactly the matching type in `argument_types`.
+		// The return value is constructed into `return_value`, which must be uninitialised storage for `return_type`
+		// (or a `T*` when a `T&` is returned). It's ignored when `void` is returned.
+		using InvokeTypedFunction = void (*)(void* object, void* const* arguments, void* return_value);
+		using ResolveFunction = void (*)(Method& method);
+
+		// What's rarely needed, kept out of `Method` like `Field::Details`. Shared by every method created for the
+		// same member function pointer.
+		struct Details
+		{
+			InvokeFunction invoke;
+			std::span<const std::string_view> attributes; // Unused currently
+			ResolveFunction resolve;
+		};
+
+		// Boxed invocation, through `details`
+		std::any invoke(void* object, std::span<std::any> arguments) const { return details->invoke(object, arguments); }
 
 		// Data
-		TemplateTypeId object_type;
+		InvokeTypedFunction invoke_typed; // Same as `invoke`, but without boxing arguments and return value in std::any
+		std::span<const TemplateTypeId> argument_types;
 		TemplateTypeId return_type;
-		std::string name;
-		std::vector<TemplateTypeId> argument_types;
-		std::vector<std::string> attributes; // Unused currently
+		TemplateTypeId object_type;
+		std::string_view name;
+		const Details* details;
 		Access access;
+	};
+
+	// All reflected types of one C++ module
+	struct Module
+	{
+		std::string_view name;
+		// Sorted by name, so a lookup can find out which module to resolve without resolving any. The types are
+		// resolved in place and handed out directly, so these are the addresses `get_type` returns.
+		std::span<Type> types;
+
+		Module* next_registered = nullptr; // Used by the registry to link modules which no lookup has seen yet
+		uint32_t generation = 0; // Of the registration, set by `add_module` and reset to 0 by `remove_module`
+	};
+
+	// One registration of a module. The module is never accessed through a handle, so a handle can still be 
+	// checked after its DLL was unloaded. When a module is registered again it gets a new generation, which
+	// makes the old handles stale.
+	struct ModuleHandle
+	{
+		// Data
+		const Module* module = nullptr;
+		uint32_t generation = 0;
 
 		// Operators
-		auto operator<=>(const Method& other) const noexcept = default;
+		bool operator==(const ModuleHandle&) const = default;
 	};
 }
 
@@ -113,6 +380,23 @@ namespace Neat
 
 namespace Neat
 {
+	namespace Detail
+	{
+		// The id when it's known at compile time, otherwise 0 until it's resolved
+		template<typename T>
+		constexpr TemplateTypeId get_constant_id()
+		{
+			if constexpr (has_stable_type_ids)
+			{
+				return get_id<T>();
+			}
+			else
+			{
+				return 0;
+			}
+		}
+	}
+
 	namespace Detail
 	{
 		template<typename TObject, typename TType, TType TObject::* PtrToMember>
@@ -130,21 +414,145 @@ namespace Neat
 			TObject* object_ = reinterpret_cast<TObject*>(object);
 			object_->*PtrToMember = std::any_cast<TType>(value);
 		}
+
+		template<typename TObject, typename TType, TType TObject::* PtrToMember>
+		void gather_erased(const void* objects, size_t stride, size_t count, void* values)
+		{
+			const auto* object = static_cast<const std::byte*>(objects);
+			TType* values_ = static_cast<TType*>(values);
+			for (size_t i = 0; i < count; i++)
+			{
+				values_[i] = reinterpret_cast<const TObject*>(object + i * stride)->*PtrToMember;
+			}
+		}
+
+		template<typename TObject, typename TType, TType TObject::* PtrToMember>
+		void scatter_erased(void* objects, size_t stride, size_t count, const void* values)
+		{
+			auto* object = static_cast<std::byte*>(objects);
+			const TType* values_ = static_cast<const TType*>(values);
+			for (size_t i = 0; i < count; i++)
+			{
+				reinterpret_cast<TObject*>(object + i * stride)->*PtrToMember = values_[i];
+			}
+		}
+
+		template<typename TObject, typename TType, TType TObject::* PtrToMember>
+		void* address_of_erased(void* object)
+		{
+			TObject* object_ = reinterpret_cast<TObject*>(object);
+			return &(object_->*PtrToMember);
+		}
+
+		// Never read from or written to, offsets are taken by applying member pointers and casts to its address.
+		// Static, as reflected types can be too big for the stack. It's zero initialised and never touched, so its
+		// pages are never committed.
+		template<typename TObject>
+		alignas(TObject) inline constinit std::byte object_storage[sizeof(TObject)]{};
+
+		template<typename TObject, typename TType, TType TObject::* PtrToMember>
+		std::size_t offset_of()
+		{
+			// The member is declared in `TObject` itself (not in a virtual base), so it's at the same offset in every object
+			const TObject* object = reinterpret_cast<const TObject*>(object_storage<TObject>);
+			return static_cast<std::size_t>(reinterpret_cast<const std::byte*>(&(object->*PtrToMember)) - object_storage<TObject>);
+		}
+
+		template<typename TObject, typename TBase>
+		std::ptrdiff_t base_offset_of()
+		{
+			// Casting to a non virtual base only adjusts the pointer, by the same offset in every object
+			const TObject* object = reinterpret_cast<const TObject*>(object_storage<TObject>);
+			return reinterpret_cast<const std::byte*>(static_cast<const TBase*>(object)) - object_storage<TObject>;
+		}
+	}
+
+	namespace Detail
+	{
+		template<typename TObject, typename TType, TType TObject::* PtrToMember>
+		void resolve_field(Field& field)
+		{
+			field.object_type = get_id<TObject>();
+			field.type = get_id<TType>();
+			field.offset = static_cast<uint32_t>(offset_of<TObject, TType, PtrToMember>());
+		}
+
+		template<typename TObject, typename TType, TType TObject::* PtrToMember>
+		inline constexpr Field::Details field_details{
+			.stable_type = get_stable_id<TType>(),
+			.get_value = &get_value_erased<TObject, TType, PtrToMember>,
+			.set_value = &set_value_erased<TObject, TType, PtrToMember>,
+			.gather_values = &gather_erased<TObject, TType, PtrToMember>,
+			.scatter_values = &scatter_erased<TObject, TType, PtrToMember>,
+			.attributes = {},
+			.resolve = &resolve_field<TObject, TType, PtrToMember>
+		};
 	}
 
 	template<typename TObject, typename TType, TType TObject::* PtrToMember>
-	Field Field::create(std::string_view name, Access access)
+	constexpr Field Field::create(std::string_view name, Access access)
 	{
+		static_assert(sizeof(TObject) <= UINT32_MAX && alignof(TType) <= UINT16_MAX, "The field doesn't fit in the compact layout of `Field`");
+
 		return Field{
-			.get_value = &Detail::get_value_erased<TObject, TType, PtrToMember>,
-			.set_value = &Detail::set_value_erased<TObject, TType, PtrToMember>,
-			.object_type = get_id<TObject>(),
-			.type = get_id<TType>(),
-			.name = std::string{ name },
-			.access = access
+			.address_of = &Detail::address_of_erased<TObject, TType, PtrToMember>,
+			.offset = 0,
+			.size = sizeof(TType),
+			.type = Detail::get_constant_id<TType>(),
+			.object_type = Detail::get_constant_id<TObject>(),
+			.alignment = alignof(TType),
+			.is_trivially_copyable = std::is_trivially_copyable_v<TType>,
+			.is_pointer = std::is_pointer_v<std::remove_all_extents_t<TType>> || std::is_member_pointer_v<std::remove_all_extents_t<TType>>,
+			.access = access,
+			.name = name,
+			.details = &Detail::field_details<TObject, TType, PtrToMember>
 		};
 	}
 
+	template<typename T>
+	T* Field::get(void* object) const
+	{
+		if (type != get_id<T>())
+		{
+			return nullptr;
+		}
+		return static_cast<T*>(address_of(object));
+	}
+
+	template<typename T>
+	bool Field::set(void* object, const T& value) const
+	{
+		T* field = get<T>(object);
+		if (field == nullptr)
+		{
+			return false;
+		}
+		*field = value;
+		return true;
+	}
+
+	template<typename T>
+	bool Field::gather(const void* objects, size_t stride, size_t count, T* values) const
+	{
+		if (type != get_id<T>())
+		{
+			return false;
+		}
+		details->gather_values(objects, stride, count, values);
+		return true;
+	}
+
+	template<typename T>
+	bool Field::scatter(void* objects, size_t stride, size_t count, const T* values) const
+	{
+		if (type != get_id<T>())
+		{
+			return false;
+		}
+		details->scatter_values(objects, stride, count, values);
+		return true;
+	}
+
 	namespace Detail
 	{
 		template<auto PtrToMemberFunction, typename TObject, typename TReturn, typename ...TArgs>
@@ -170,19 +578,368 @@ namespace Neat
 		}
 	}
 
+	namespace Detail
+	{
+		template<typename TArg>
+		decltype(auto) unerase_argument(void* argument)
+		{
+			auto* argument_ = static_cast<std::remove_reference_t<TArg>*>(argument);
+			if constexpr (std::is_rvalue_reference_v<TArg>)
+			{
+				return std::move(*argument_);
+			}
+			else
+			{
+				return (*argument_); // By value arguments are copied from the caller's buffer
+			}
+		}
+
+		template<auto PtrToMemberFunction, typename TObject, typename TReturn, typename ...TArgs>
+		void invoke_typed_erased(void* object, void* const* arguments, void* return_value)
+		{
+			TObject* object_ = reinterpret_cast<TObject*>(object);
+
+			[&]<size_t... Indices>(std::index_sequence<Indices...>)
+			{
+				if constexpr (std::is_same_v<TReturn, void>)
+				{
+					(object_->*PtrToMemberFunction)(unerase_argument<TArgs>(arguments[Indices])...);
+				}
+				else if constexpr (std::is_reference_v<TReturn>)
+				{
+					using TReferee = std::remove_reference_t<TReturn>;
+					*static_cast<TReferee**>(return_value) = &(object_->*PtrToMemberFunction)(unerase_argument<TArgs>(arguments[Indices])...);
+				}
+				else
+				{
+					std::construct_at(static_cast<std::remove_cv_t<TReturn>*>(return_value), 
+						(object_->*PtrToMemberFunction)(unerase_argument<TArgs>(arguments[Indices])...));
+				}
+			}(std::index_sequence_for<TArgs...>{});
+		}
+	}
+
+	namespace Detail
+	{
+		// Shared by all methods with the same argument types. Filled in only once, when the first of them is resolved,
+		// other threads can be reading it already while methods of a later module are resolved.
+		template<typename... TArgs>
+		inline constinit std::array<TemplateTypeId, sizeof...(TArgs)> argument_type_ids{ get_constant_id<TArgs>()... };
+		template<typename... TArgs>
+		inline constinit std::once_flag argument_type_ids_resolved;
+
+		template<typename TObject, typename TReturn, typename ...TArgs>
+		void resolve_method(Method& method)
+		{
+			method.object_type = get_id<TObject>();
+			method.return_type = get_id<TReturn>();
+			if constexpr (!has_stable_type_ids) // Otherwise they are known up front
+			{
+				std::call_once(argument_type_ids_resolved<TArgs...>, [] { argument_type_ids<TArgs...> = { get_id<TArgs>()... }; });
+			}
+		}
+
+		template<auto PtrToMemberFunction, typename TObject, typename TReturn, typename ...TArgs>
+		inline constexpr Method::Details method_details{
+			.invoke = &invoke_erased<PtrToMemberFunction, TObject, TReturn, TArgs...>,
+			.attributes = {},
+			.resolve = &resolve_method<TObject, TReturn, TArgs...>
+		};
+	}
+
 	template<auto PtrToMemberFunction, typename TObject, typename TReturn, typename ...TArgs>
-	Method Method::create(std::string_view name, Access access)
+	constexpr Method Method::create(std::string_view name, Access access)
 	{
 		static_assert(std::is_same_v<decltype(PtrToMemberFunction), TReturn (TObject::*)(TArgs...)>,
 			"PtrToMemberFunction needs to be a value of type `TReturn (TObject::*)(TArgs...)`");
 
 		return Method{
-			.invoke = &Detail::invoke_erased<PtrToMemberFunction, TObject, TReturn, TArgs...>,
-			.object_type = get_id<TObject>(),
-			.return_type = get_id<TReturn>(),
-			.name = std::string{name},
-			.argument_types = {get_id<TArgs>()...},
+			.invoke_typed = &Detail::invoke_typed_erased<PtrToMemberFunction, TObject, TReturn, TArgs...>,
+			.argument_types = Detail::argument_type_ids<TArgs...>,
+			.return_type = Detail::get_constant_id<TReturn>(),
+			.object_type = Detail::get_constant_id<TObject>(),
+			.name = name,
+			.details = &Detail::method_details<PtrToMemberFunction, TObject, TReturn, TArgs...>,
 			.access = access
 		};
 	}
+
+	namespace Detail
+	{
+		template<typename T>
+		void resolve_type(Type& type)
+		{
+			type.id = get_id<T>();
+		}
+
+		template<typename T>
+		void default_construct_erased(void* objects, size_t count)
+		{
+			std::uninitialized_value_construct_n(static_cast<T*>(objects), count);
+		}
+
+		template<typename T>
+		void copy_construct_erased(void* objects, const void* sources, size_t count)
+		{
+			std::uninitialized_copy_n(static_cast<const T*>(sources), count, static_cast<T*>(objects));
+		}
+
+		template<typename T>
+		void move_construct_erased(void* objects, void* sources, size_t count)
+		{
+			std::uninitialized_move_n(static_cast<T*>(sources), count, static_cast<T*>(objects));
+		}
+
+		template<typename T>
+		void destroy_erased(void* objects, size_t count)
+		{
+			std::destroy_n(static_cast<T*>(objects), count);
+		}
+
+		REFL_API bool enable_copy_construction(TemplateTypeId type_id, Type::CopyFunction copy_constructor);
+		REFL_API bool enable_move_construction(TemplateTypeId type_id, Type::MoveFunction move_constructor);
+
+		// Leaves the rest of `type` as it is. Copying and moving aren't set here, see `enable_copy_construction`.
+		template<typename T>
+		constexpr Type with_lifetime(Type type)
+		{
+			type.size = static_cast<uint32_t>(sizeof(T));
+			type.alignment = static_cast<uint16_t>(alignof(T));
+			if constexpr (std::is_default_constructible_v<T>)
+			{
+				type.default_constructor = &default_construct_erased<T>;
+			}
+			if constexpr (std::is_destructible_v<T>)
+			{
+				type.destructor = &destroy_erased<T>;
+			}
+			return type;
+		}
+
+		template<typename TObject, typename TBase>
+		void* upcast_erased(void* object)
+		{
+			return static_cast<TBase*>(static_cast<TObject*>(object));
+		}
+
+		// A virtual base can't be cast down to the derived type
+		template<typename TObject, typename TBase>
+		constexpr bool is_virtual_base = !requires (TBase* base) { static_cast<TObject*>(base); };
+
+		template<typename TObject, typename TBase>
+		void resolve_base_class(BaseClass& base)
+		{
+			base.base_id = get_id<TBase>();
+
+			if constexpr (std::is_convertible_v<TObject*, TBase*> && !is_virtual_base<TObject, TBase>)
+			{
+				base.offset = base_offset_of<TObject, TBase>();
+			}
+		}
+	}
+
+	namespace Detail
+	{
+		template<typename TEnum>
+		void resolve_enum(Enum& enumeration)
+		{
+			enumeration.underlying_type = get_id<std::underlying_type_t<TEnum>>();
+
+			for (size_t i = 0; i < enumeration.by_value.size(); i++)
+			{
+				enumeration.by_value[i] = &enumeration.enumerators[i];
+			}
+			// Stable, so the first by name comes first for enumerators sharing a value
+			std::ranges::stable_sort(enumeration.by_value, {}, &Enumerator::value);
+		}
+	}
+
+	template<auto Value>
+	constexpr Enumerator Enumerator::create(std::string_view name)
+	{
+		static_assert(std::is_enum_v<decltype(Value)>, "Value needs to be an enumerator");
+		return Enumerator{ .name = name, .value = static_cast<int64_t>(Value) };
+	}
+
+	template<typename TEnum>
+	constexpr Enum Enum::create(std::span<const Enumerator> enumerators, std::span<const Enumerator*> by_value)
+	{
+		return Enum{
+			.enumerators = enumerators,
+			.by_value = by_value,
+			.underlying_type = Detail::get_constant_id<std::underlying_type_t<TEnum>>(),
+			.resolve = &Detail::resolve_enum<TEnum>
+		};
+	}
+
+	inline const Enumerator* Enum::find(std::string_view name) const
+	{
+		auto it = std::ranges::lower_bound(enumerators, name, {}, &Enumerator::name);
+		return (it != enumerators.end() && it->name == name ? &*it : nullptr);
+	}
+
+	inline const Enumerator* Enum::find(int64_t value) const
+	{
+		auto it = std::ranges::lower_bound(by_value, value, {}, &Enumerator::value);
+		return (it != by_value.end() && (*it)->value == value ? *it : nullptr);
+	}
+
+	template<typename TEnum>
+	std::string_view Enum::to_name(TEnum value) const
+	{
+		const Enumerator* enumerator = find(static_cast<int64_t>(value));
+		return (enumerator ? enumerator->name : std::string_view{});
+	}
+
+	template<typename TEnum>
+	bool Enum::to_value(std::string_view name, TEnum& value) const
+	{
+		const Enumerator* enumerator = find(name);
+		if (enumerator == nullptr)
+		{
+			return false;
+		}
+		value = static_cast<TEnum>(enumerator->value);
+		return true;
+	}
+
+	template<typename T>
+	constexpr Type Type::create(std::string_view name, std::span<BaseClass> bases, std::span<Field> fields, std::span<Method> methods)
+	{
+		return Detail::with_lifetime<T>(Type{
+			.name = name,
+			.id = Detail::get_constant_id<T>(),
+			.bases = bases,
+			.fields = fields,
+			.methods = methods,
+			.resolve = &Detail::resolve_type<T>
+		});
+	}
+
+	template<typename TEnum>
+	constexpr Type Type::create(std::string_view name, Enum& enumeration)
+	{
+		static_assert(std::is_enum_v<TEnum>, "Only enums have enumerators");
+		return Detail::with_lifetime<TEnum>(Type{
+			.name = name,
+			.id = Detail::get_constant_id<TEnum>(),
+			.bases = {},
+			.fields = {},
+			.methods = {},
+			.enumeration = &enumeration,
+			.resolve = &Detail::resolve_type<TEnum>
+		});
+	}
+
+	template<typename TObject, typename TBase>
+	constexpr BaseClass BaseClass::create(Access access)
+	{
+		UpcastFunction upcast = nullptr;
+		if constexpr (std::is_convertible_v<TObject*, TBase*>)
+		{
+			upcast = &Detail::upcast_erased<TObject, TBase>;
+		}
+
+		return BaseClass{
+			.base_id = Detail::get_constant_id<TBase>(),
+			.access = access,
+			.is_virtual = Detail::is_virtual_base<TObject, TBase>,
+			.offset = 0,
+			.upcast = upcast,
+			.resolve = &Detail::resolve_base_class<TObject, TBase>
+		};
+	}
+
+	template<typename T>
+	bool enable_copy_construction()
+	{
+		static_assert(std::is_copy_constructible_v<T>, "Only copy constructible types can be copied");
+		return Detail::enable_copy_construction(get_id<T>(), &Detail::copy_construct_erased<T>);
+	}
+
+	template<typename T>
+	bool enable_move_construction()
+	{
+		static_assert(std::is_move_constructible_v<T>, "Only move constructible types can be moved");
+		return Detail::enable_move_construction(get_id<T>(), &Detail::move_construct_erased<T>);
+	}
+
+	inline bool Type::default_construct(void* objects, size_t count) const
+	{
+		if (default_constructor == nullptr)
+		{
+			return false;
+		}
+		default_constructor(objects, count);
+		return true;
+	}
+
+	inline bool Type::copy_construct(void* objects, const void* sources, size_t count) const
+	{
+		CopyFunction copy = std::atomic_ref{copy_constructor}.load(std::memory_order_acquire);
+		if (copy == nullptr)
+		{
+			return false;
+		}
+		copy(objects, sources, count);
+		return true;
+	}
+
+	inline bool Type::move_construct(void* objects, void* sources, size_t count) const
+	{
+		MoveFunction move = std::atomic_ref{move_constructor}.load(std::memory_order_acquire);
+		if (move == nullptr)
+		{
+			return false;
+		}
+		move(objects, sources, count);
+		return true;
+	}
+
+	inline bool Type::destroy(void* objects, size_t count) const
+	{
+		if (destructor == nullptr)
+		{
+			return false;
+		}
+		destructor(objects, count);
+		return true;
+	}
+
+	inline bool Type::is_derived_from(TemplateTypeId base_id) const
+	{
+		auto bases = get_inheritance().bases;
+		auto it = std::ranges::lower_bound(bases, base_id, {}, &InheritedBase::base_id);
+		return it != bases.end() && it->base_id == base_id;
+	}
+
+	inline void* Type::upcast(void* object, TemplateTypeId base_id) const
+	{
+		auto bases = get_inheritance().bases;
+		auto it = std::ranges::lower_bound(bases, base_id, {}, &InheritedBase::base_id);
+		if (it == bases.end() || it->base_id != base_id)
+		{
+			return nullptr;
+		}
+		return it->upcast(object);
+	}
+
+	inline void* InheritedBase::upcast(void* object) const
+	{
+		if (has_fixed_offset)
+		{
+			return static_cast<std::byte*>(object) + offset;
+		}
+		if (base == nullptr || base->upcast == nullptr)
+		{
+			return nullptr;
+		}
+		return base->upcast(via ? via->upcast(object) : object);
+	}
+
+	inline void* InheritedField::address_of(void* object) const
+	{
+		void* declaring_object = (base ? base->upcast(object) : object);
+		return declaring_object ? field->address_of(declaring_object) : nullptr;
+	}
 }
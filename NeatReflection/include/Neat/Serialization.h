@@ -0,0 +1,98 @@
+#pragma once
+#include "Neat/DllMacro.h"
+#include "Neat/TemplateTypeId.h"
+#include "Neat/Reflection.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+
+// Interface
+// ===========================================================================
+
+namespace Neat
+{
+	// How an object of a type is serialized, compiled once from its reflected fields (including inherited ones).
+	// Fields of other reflected types (except enums) are expanded into their own fields, also when they are trivially
+	// copyable. Other trivially copyable fields are copied as they are, so the whole object comes down to a list of
+	// copies. Adjacent copies are merged into one run. Pointers and member pointers are skipped, even though they are
+	// trivially copyable.
+	struct SerializationPlan
+	{
+		struct Run
+		{
+			uint32_t offset; // Inside the object
+			uint32_t size;
+		};
+
+		// Data
+		TemplateTypeId type_id = 0;
+		uint64_t schema_hash = 0; // Of the names, types and sizes of the serialized fields, which stays the same across builds
+		uint32_t payload_size = 0; // Sum of the run sizes
+		std::vector<Run> runs;
+		std::vector<std::string> skipped_fields; // Which can't be serialized, as a path like `transform.name`
+	};
+
+	// The format is the schema hash and the payload size, followed by the payload: the runs back to back without
+	// padding, in the native byte order. A reader with a different schema (another version of the type) rejects the
+	// object, and can still skip past it using the payload size.
+	constexpr size_t serialization_header_size = sizeof(uint64_t) + sizeof(uint32_t);
+
+	REFL_API SerializationPlan compile_serialization_plan(const Type& type);
+	// Compiled on first use and cached, until the module of the type or of one of its bases or nested types is removed.
+	// The reference stays valid until the module of the type itself is removed.
+	REFL_API const SerializationPlan& get_serialization_plan(const Type& type);
+
+	// Appends `object` to `out`
+	REFL_API void serialize(const SerializationPlan& plan, const void* object, std::vector<std::byte>& out);
+	// Reads `object` from the start of `in`, and advances `in` past it. Returns false when the data was written with
+	// another schema or is cut off, `object` is left untouched then.
+	REFL_API bool deserialize(const SerializationPlan& plan, void* object, std::span<const std::byte>& in);
+
+	// Returns false when `T` isn't reflected
+	template<typename T>
+	bool serialize(const T& object, std::vector<std::byte>& out);
+	template<typename T>
+	bool deserialize(T& object, std::span<const std::byte>& in);
+
+	namespace Detail
+	{
+		// Called by `remove_module`, while holding the registry lock
+		void drop_serialization_plans(std::span<Type> removed_types);
+	}
+}
+
+
+// Implementation
+// ===========================================================================
+
+namespace Neat
+{
+	template<typename T>
+	bool serialize(const T& object, std::vector<std::byte>& out)
+	{
+		Type* type = get_type<T>();
+		if (type == nullptr)
+		{
+			return false;
+		}
+
+		serialize(get_serialization_plan(*type), &object, out);
+		return true;
+	}
+
+	template<typename T>
+	bool deserialize(T& object, std::span<const std::byte>& in)
+	{
+		Type* type = get_type<T>();
+		if (type == nullptr)
+		{
+			return false;
+		}
+
+		return deserialize(get_serialization_plan(*type), &object, in);
+	}
+}
@@ -2,18 +2,150 @@
 #include "Neat/DllMacro.h"
 
 #include <cstdint>
+#include <string_view>
 
 
 namespace Neat
 {
+	// The same in every build and process: the 64 bit FNV-1a hash of the fully qualified type name, as the generator
+	// renders it (`Namespace::MyStruct`, `const char*`).
+	using StableTypeId = uint64_t;
+
+	constexpr StableTypeId get_stable_type_id(std::string_view qualified_name);
+
+	// The name of `T` as the compiler spells it, normalised to what the generator renders for class types
+	// (without `struct`/`class` and without spaces before `*` and `&`). Builtin types can be spelled differently by
+	// each compiler (`__int64` by MSVC), so ids of those are only stable between builds of the same compiler.
+	template<typename T>
+	constexpr StableTypeId get_stable_id();
+
+	// With `NEAT_REFLECTION_STABLE_TYPE_IDS` defined, ids are `StableTypeId`s. They are `constexpr` then, so they can
+	// be used in switches, sent over the network or persisted, and they are the same in every DLL. Otherwise ids are
+	// handed out densely in the order of first use, which differs per process.
+#ifdef NEAT_REFLECTION_STABLE_TYPE_IDS
+	using TemplateTypeId = StableTypeId;
+	constexpr bool has_stable_type_ids = true;
+#else
 	using TemplateTypeId = uint32_t;
+	constexpr bool has_stable_type_ids = false;
+#endif
 
+	// For types which aren't C++ types, like the ones added at runtime. Never returns 0.
 	REFL_API TemplateTypeId generate_new_type_id();
 
+#ifdef NEAT_REFLECTION_STABLE_TYPE_IDS
+	template<typename T>
+	constexpr TemplateTypeId get_id()
+	{
+		return get_stable_id<T>();
+	}
+#else
 	template<typename T>
 	TemplateTypeId get_id()
 	{
 		static TemplateTypeId id = generate_new_type_id();
 		return id;
 	}
-}
\ No newline at end of file
+#endif
+}
+
+
+// Implementation
+// ===========================================================================
+
+namespace Neat
+{
+	namespace Detail
+	{
+		constexpr uint64_t fnv_offset_basis = 0xCBF29CE484222325;
+		constexpr uint64_t fnv_prime = 0x100000001B3;
+
+		template<typename T>
+		constexpr std::string_view get_raw_type_name()
+		{
+#if defined(_MSC_VER) && !defined(__clang__)
+			// "auto __cdecl Neat::Detail::get_raw_type_name<struct MyStruct>(void)"
+			constexpr std::string_view signature = __FUNCSIG__;
+			constexpr std::string_view prefix = "get_raw_type_name<";
+			constexpr size_t start = signature.find(prefix) + prefix.size();
+			constexpr size_t end = signature.rfind(">(void)");
+#else
+			// "constexpr std::string_view Neat::Detail::get_raw_type_name() [with T = MyStruct; std::string_view = ...]" (GCC)
+			// or "std::string_view Neat::Detail::get_raw_type_name() [T = MyStruct]" (Clang)
+			constexpr std::string_view signature = __PRETTY_FUNCTION__;
+			constexpr std::string_view prefix = "T = ";
+			constexpr size_t start = signature.find(prefix) + prefix.size();
+			constexpr size_t end = (signature.find("; ", start) != std::string_view::npos ? signature.find("; ", start) : signature.size() - 1);
+#endif
+			return signature.substr(start, end - start);
+		}
+
+		constexpr bool is_identifier_character(char character)
+		{
+			return (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') ||
+				(character >= '0' && character <= '9') || character == '_';
+		}
+
+		// Hashes `name` as it would've been normalised, so no normalised copy needs to be stored
+		constexpr StableTypeId hash_normalised_type_name(std::string_view name)
+		{
+			constexpr std::string_view elaborations[] = { "struct ", "class ", "union ", "enum " };
+
+			uint64_t hash = fnv_offset_basis;
+			for (size_t i = 0; i < name.size(); i++)
+			{
+				const bool is_token_start = (i == 0 || !is_identifier_character(name[i - 1]));
+				bool is_elaboration = false;
+				for (auto elaboration : elaborations)
+				{
+					if (is_token_start && name.substr(i).starts_with(elaboration))
+					{
+						i += elaboration.size() - 1;
+						is_elaboration = true;
+						break;
+					}
+				}
+				if (is_elaboration)
+				{
+					continue;
+				}
+
+				if (name[i] == ' ' && i + 1 < name.size() && (name[i + 1] == '*' || name[i + 1] == '&'))
+				{
+					continue;
+				}
+
+				// MSVC appends the module a type is attached to, like `MyStruct@TestModule1`
+				if (name[i] == '@')
+				{
+					while (i + 1 < name.size() && (is_identifier_character(name[i + 1]) || name[i + 1] == '.' || 
+						(name[i + 1] == ':' && !name.substr(i + 1).starts_with("::")))) // A partition, but not a nested name
+					{
+						i++;
+					}
+					continue;
+				}
+
+				hash = (hash ^ static_cast<unsigned char>(name[i])) * fnv_prime;
+			}
+			return hash;
+		}
+	}
+
+	constexpr StableTypeId get_stable_type_id(std::string_view qualified_name)
+	{
+		uint64_t hash = Detail::fnv_offset_basis;
+		for (char character : qualified_name)
+		{
+			hash = (hash ^ static_cast<unsigned char>(character)) * Detail::fnv_prime;
+		}
+		return hash;
+	}
+
+	template<typename T>
+	constexpr StableTypeId get_stable_id()
+	{
+		constexpr StableTypeId id = Detail::hash_normalised_type_name(Detail::get_raw_type_name<T>());
+		return id;
+	}
+}
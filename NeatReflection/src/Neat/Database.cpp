@@ -0,0 +1,118 @@
+#include "Neat/Database.h"
+
+#include <algorithm>
+#include <cstdint>
+
+
+namespace Neat
+{
+	template<typename TRecord>
+	static bool get_table(std::span<const std::byte> data, DatabaseFormat::Table table, std::span<const TRecord>& records)
+	{
+		if (table.offset % DatabaseFormat::table_alignment != 0 || table.offset > data.size() ||
+			table.count > (data.size() - table.offset) / sizeof(TRecord))
+		{
+			return false;
+		}
+
+		records = { reinterpret_cast<const TRecord*>(data.data() + table.offset), table.count };
+		return true;
+	}
+
+	static bool is_in(DatabaseFormat::Range range, size_t count)
+	{
+		return range.first <= count && range.count <= count - range.first;
+	}
+
+	static bool is_in(DatabaseFormat::String string, std::string_view strings)
+	{
+		return string.offset <= strings.size() && string.size <= strings.size() - string.offset;
+	}
+
+	static bool is_valid(Access access)
+	{
+		return access == Access::Public || access == Access::Protected || access == Access::Private;
+	}
+
+	static bool is_valid(DatabaseFormat::TypeKind kind)
+	{
+		return kind == DatabaseFormat::TypeKind::Class || kind == DatabaseFormat::TypeKind::Enum;
+	}
+
+	bool Database::open(std::span<const std::byte> data)
+	{
+		*this = {};
+
+		if (data.size() < sizeof(DatabaseFormat::Header) || reinterpret_cast<uintptr_t>(data.data()) % DatabaseFormat::table_alignment != 0)
+		{
+			return false;
+		}
+
+		const auto& file_header = *reinterpret_cast<const DatabaseFormat::Header*>(data.data());
+		if (file_header.magic != DatabaseFormat::magic || file_header.version != DatabaseFormat::version || file_header.file_size != data.size())
+		{
+			return false;
+		}
+
+		std::span<const char> string_table;
+		Database database;
+		if (!get_table(data, file_header.types, database.types) ||
+			!get_table(data, file_header.bases, database.bases) ||
+			!get_table(data, file_header.fields, database.fields) ||
+			!get_table(data, file_header.methods, database.methods) ||
+			!get_table(data, file_header.arguments, database.arguments) ||
+			!get_table(data, file_header.enumerators, database.enumerators) ||
+			!get_table(data, file_header.strings, string_table))
+		{
+			return false;
+		}
+		database.strings = { string_table.data(), string_table.size() };
+
+		// Checked once here, so the accessors don't need to
+		const auto& strings = database.strings;
+		bool is_valid_database = is_in(file_header.module_name, strings);
+		for (auto& type : database.types)
+		{
+			is_valid_database &= is_in(type.name, strings) && is_valid(type.kind) && is_in(type.bases, database.bases.size()) &&
+				is_in(type.fields, database.fields.size()) && is_in(type.methods, database.methods.size()) &&
+				is_in(type.enumerators, database.enumerators.size());
+		}
+		for (auto& base : database.bases)
+		{
+			is_valid_database &= is_in(base.name, strings) && is_valid(base.access);
+		}
+		for (auto& field : database.fields)
+		{
+			is_valid_database &= is_in(field.name, strings) && is_in(field.type_name, strings) && is_valid(field.access);
+		}
+		for (auto& method : database.methods)
+		{
+			is_valid_database &= is_in(method.name, strings) && is_in(method.return_type_name, strings) &&
+				is_in(method.arguments, database.arguments.size()) && is_valid(method.access);
+		}
+		for (auto& argument : database.arguments)
+		{
+			is_valid_database &= is_in(argument.type_name, strings);
+		}
+		for (auto& enumerator : database.enumerators)
+		{
+			is_valid_database &= is_in(enumerator.name, strings);
+		}
+		is_valid_database &= std::ranges::is_sorted(database.types, {}, &TypeRecord::id);
+
+		if (!is_valid_database)
+		{
+			return false;
+		}
+
+		database.header = &file_header;
+		*this = database;
+		return true;
+	}
+
+	const Database::TypeRecord* Database::find_type(StableTypeId id) const
+	{
+		auto it = std::ranges::lower_bound(types, id, {}, &TypeRecord::id);
+		return (it != types.end() && it->id == id ? &*it : nullptr);
+	}
+}
@@ -1,51 +1,1200 @@
 #include "Neat/Reflection.h"
+#include "Neat/Instrumentation.h"
+#include "Neat/Serialization.h"
 
+#include <atomic>
+#include <chrono>
 #include <unordered_map>
+#include <unordered_set>
+#include <memory>
+#include <mutex>
 #include <vector>
-#include <string>
+#include <string_view>
+#include <algorithm>
+#include <bit>
+#include <utility>
+#include <cassert>
 
 
 namespace Neat
 {
-	struct TypeContainer
+	// Instrumentation, see `Neat/Instrumentation.h`. Without it every hook is empty.
+#ifdef NEAT_REFLECTION_INSTRUMENTATION
+	struct Instrumentation
 	{
-		std::unordered_map<std::string, uint32_t> by_type_name;
-		std::unordered_map<TemplateTypeId, uint32_t> by_template_type_id;
-		std::vector<Type> types;
+		std::atomic<uint64_t> added_type_count = 0;
+		std::atomic<uint64_t> added_type_bytes = 0;
+		std::atomic<uint64_t> name_hits = 0; // Counted without locking, lookups by name and id are lock free
+		std::atomic<uint64_t> name_misses = 0;
+		std::atomic<uint64_t> id_hits = 0;
+		std::atomic<uint64_t> id_misses = 0;
+
+		// Only accessed while holding `registry.mutex`
+		uint64_t allocated_bytes = 0; // By the registry, in total
+		std::vector<ModuleStatistics> modules;
+	};
+	static Instrumentation instrumentation;
+
+	// Measures one registration while holding `registry.mutex`
+	class RegistrationProbe
+	{
+	public:
+		std::chrono::nanoseconds get_time() const { return std::chrono::steady_clock::now() - start; }
+		uint64_t get_allocated_bytes() const { return instrumentation.allocated_bytes - allocated_bytes_before; }
+
+	private:
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		uint64_t allocated_bytes_before = instrumentation.allocated_bytes;
+	};
+
+	static void count_allocation(size_t bytes)
+	{
+		instrumentation.allocated_bytes += bytes;
+	}
+
+	static void count_added_type(const RegistrationProbe& probe)
+	{
+		instrumentation.added_type_count.fetch_add(1, std::memory_order_relaxed);
+		instrumentation.added_type_bytes.fetch_add(probe.get_allocated_bytes(), std::memory_order_relaxed);
+	}
+
+	static void count_resolved_module(const Module& module, const RegistrationProbe& probe)
+	{
+		instrumentation.modules.push_back({ 
+			.name = std::string{ module.name }, 
+			.type_count = module.types.size(), 
+			.resolve_time = probe.get_time(), 
+			.allocated_bytes = probe.get_allocated_bytes() 
+		});
+	}
+
+	static void count_lookup_by_name(const Type* found)
+	{
+		(found ? instrumentation.name_hits : instrumentation.name_misses).fetch_add(1, std::memory_order_relaxed);
+	}
+
+	static void count_lookup_by_id(const Type* found)
+	{
+		(found ? instrumentation.id_hits : instrumentation.id_misses).fetch_add(1, std::memory_order_relaxed);
+	}
+#else
+	struct RegistrationProbe {};
+
+	static void count_allocation(size_t) {}
+	static void count_added_type(const RegistrationProbe&) {}
+	static void count_resolved_module(const Module&, const RegistrationProbe&) {}
+	static void count_lookup_by_name(const Type*) {}
+	static void count_lookup_by_id(const Type*) {}
+#endif
+
+
+	// Append only, so the published part never changes and can be handed out as a span.
+	struct TypeList
+	{
+		explicit TypeList(size_t capacity) : capacity(capacity), types(std::make_unique<Type*[]>(capacity)) {}
+
+		const size_t capacity;
+		std::atomic<size_t> size = 0;
+		std::unique_ptr<Type*[]> types;
+		uint64_t retired_at = 0; // `TypeRegistry::list_rebuild_count` when it was replaced, only accessed while holding `mutex`
+	};
+
+	// Open addressing with linear probing on `Type::id`, kept at most half full. The id is used as its own hash: dense 
+	// ids (see `generate_new_type_id`) get a slot each without collisions, and stable ids are hashes already.
+	// A removed type only leaves a nullptr behind, a type added again with the same id gets the same slot. A reloaded
+	// DLL gets new dense ids though, so when the table is full of removed types it's compacted in place instead of
+	// growing. `version` is odd meanwhile, lookups which overlap with it look again while holding `registry.mutex`.
+	struct IdTable
+	{
+		explicit IdTable(size_t capacity) 
+			: capacity(capacity)
+			, keys(std::make_unique<std::atomic<TemplateTypeId>[]>(capacity))
+			, types(std::make_unique<std::atomic<Type*>[]>(capacity)) 
+		{}
+
+		const size_t capacity; // Power of two
+		size_t count = 0; // Of used keys
+		std::atomic<uint64_t> version = 0;
+		std::unique_ptr<std::atomic<TemplateTypeId>[]> keys; // 0 for an unused slot, ids are never 0
+		std::unique_ptr<std::atomic<Type*>[]> types;
+	};
+
+	// Open addressing with linear probing on `Type::name`. Kept at most half full, so probes stay short.
+	// Names are views into the registered types, so no strings need to be constructed for lookups.
+	// Removed types leave a `removed_type_marker` behind, so probes for other types continue past them.
+	struct NameTable
+	{
+		explicit NameTable(size_t capacity) : capacity(capacity), slots(std::make_unique<std::atomic<Type*>[]>(capacity)) {}
+
+		const size_t capacity; // Power of two
+		size_t count = 0; // Including removed slots
+		std::unique_ptr<std::atomic<Type*>[]> slots;
+	};
+
+	// Types added with `add_type` are bump allocated from chunks, which never move and are never freed. 
+	// (A std::deque would do too, but MSVC's allocates every `Type` on its own.)
+	class TypeArena
+	{
+	public:
+		Type& add(Type&& type)
+		{
+			if (chunks.empty() || used_in_last_chunk == chunk_size)
+			{
+				chunks.push_back(std::make_unique<Type[]>(chunk_size));
+				count_allocation(chunk_size * sizeof(Type));
+				used_in_last_chunk = 0;
+			}
+
+			Type& added = chunks.back()[used_in_last_chunk++];
+			added = std::move(type);
+			return added;
+		}
+
+	private:
+		static constexpr size_t chunk_size = 64;
+		std::vector<std::unique_ptr<Type[]>> chunks;
+		size_t used_in_last_chunk = 0;
+	};
+
+	// Owns what an `Inheritance` points to
+	struct InheritanceStorage
+	{
+		Inheritance inheritance;
+		std::vector<InheritedBase> bases;
+		std::vector<InheritedField> fields;
+	};
+
+	// Owns the tables a `MemberIndex` points to
+	struct MemberIndexStorage
+	{
+		MemberIndex index;
+		std::vector<const Field*> fields;
+		std::vector<const Method*> methods;
 	};
-	static TypeContainer type_container;
 
+	// Lookups never lock or wait: the tables are only ever appended to, and they grow by publishing a bigger copy.
+	// Readers keep using the copy they loaded, so old copies are kept alive with the registry. A lookup which misses 
+	// in a copy that was just replaced falls back to the locked path, which looks again.
+	// Removing and adding modules again doesn't grow the tables, the slots of removed types are reused (see `IdTable`
+	// and `NameTable`). What's dropped with removed types (lists, inheritances, member indices) is freed, or kept 
+	// while it could still be in use.
+	struct TypeRegistry
+	{
+		std::atomic<TypeList*> list = nullptr;
+		std::atomic<IdTable*> by_template_type_id = nullptr;
+		std::atomic<NameTable*> by_type_name = nullptr;
+		std::atomic<bool> has_unresolved_modules = false; // Only written while holding `mutex`
+		std::atomic<bool> is_list_stale = false; // Set when types were removed, `list` is rebuilt by `get_types`
+		std::atomic<uint32_t> list_readers = 0; // Calls of `get_types` which could be reading a list they loaded
+
+		// Everything below is only accessed while holding `mutex`
+		std::mutex mutex;
+		TypeArena added_types; // Types of modules aren't copied, they are resolved in place in the module's table
+		std::vector<std::unique_ptr<TypeList>> lists; // The current one, and those replaced since the last rebuild but one
+		uint64_t list_rebuild_count = 0;
+		std::vector<std::unique_ptr<IdTable>> id_tables;
+		std::vector<std::unique_ptr<NameTable>> name_tables;
+		std::unordered_set<const Type*> removed_types; // Still in `list`, until it's rebuilt
+		std::unordered_map<const Type*, std::unique_ptr<InheritanceStorage>> inheritances; // Cached in `Type::inheritance`
+		// Of types which weren't removed, but had a removed base. References to them can be kept for any time, so
+		// they live as long as the registry. Only grows when such an inheritance was used before its base was removed.
+		std::vector<std::unique_ptr<InheritanceStorage>> dropped_inheritances;
+		std::unordered_map<const Type*, std::unique_ptr<MemberIndexStorage>> member_indices; // Cached in `Type::member_index`
+
+		struct RegisteredModule
+		{
+			Module* module;
+			uint32_t generation;
+			bool is_resolved = false;
+			bool ids_indexed = false; // In `unresolved_module_by_template_type_id`, while unresolved
+		};
+		std::unordered_map<const Module*, RegisteredModule> registered_modules; // Node based, so pointers to them stay valid
+		std::vector<RegisteredModule*> unresolved_modules; // Of which no type has been looked up yet
+		std::unordered_map<TemplateTypeId, Module*> unresolved_module_by_template_type_id; // Only filled in when an id lookup misses
+
+		~TypeRegistry() { is_registry_destroyed = true; }
+		static constinit inline bool is_registry_destroyed = false; // Generated modules remove themselves during static destruction
+	};
+	static TypeRegistry registry;
+
+	// Intrusive list, so registering a module never allocates or locks. `constinit` so modules can safely be 
+	// registered from static initialisers in other translation units, and from threads loading a DLL.
+	static constinit std::atomic<Module*> first_registered_module = nullptr;
+	static constinit std::atomic<uint32_t> last_module_generation = 0;
+
+	static constinit Type removed_type_marker{};
+
+
+	static Type* find_type(std::string_view type_name)
+	{
+		const NameTable* table = registry.by_type_name.load(std::memory_order_acquire);
+		if (table == nullptr)
+		{
+			return nullptr;
+		}
+
+		const size_t mask = table->capacity - 1;
+		for (size_t i = std::hash<std::string_view>{}(type_name) & mask; ; i = (i + 1) & mask)
+		{
+			Type* type = table->slots[i].load(std::memory_order_acquire);
+			if (type == nullptr || (type != &removed_type_marker && type->name == type_name))
+			{
+				return type;
+			}
+		}
+	}
+
+	// Returns false when the table was compacted meanwhile, `found` can be wrong then. Never happens while 
+	// holding `registry.mutex`.
+	static bool try_find_type(TemplateTypeId type_id, Type*& found)
+	{
+		found = nullptr;
+		const IdTable* table = registry.by_template_type_id.load(std::memory_order_acquire);
+		if (table == nullptr)
+		{
+			return true;
+		}
+
+		const uint64_t version = table->version.load(std::memory_order_acquire);
+		if (version % 2 != 0)
+		{
+			return false;
+		}
+
+		const size_t mask = table->capacity - 1;
+		for (size_t i = static_cast<size_t>(type_id) & mask; ; i = (i + 1) & mask)
+		{
+			const TemplateTypeId key = table->keys[i].load(std::memory_order_acquire);
+			if (key == type_id)
+			{
+				found = table->types[i].load(std::memory_order_acquire);
+				break;
+			}
+			if (key == 0)
+			{
+				break;
+			}
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return table->version.load(std::memory_order_relaxed) == version;
+	}
+
+	static Type* find_type(TemplateTypeId type_id)
+	{
+		Type* found;
+		[[maybe_unused]] const bool is_consistent = try_find_type(type_id, found);
+		assert(is_consistent && "Only called while holding `registry.mutex`");
+		return found;
+	}
+
+	// Only true when another lookup could still find types which aren't in the tables yet
+	static bool may_have_unresolved_modules()
+	{
+		return first_registered_module.load(std::memory_order_acquire) != nullptr 
+			|| registry.has_unresolved_modules.load(std::memory_order_acquire);
+	}
+
+	// The publish functions need to be called while holding `registry.mutex`
+
+	static void rebuild_list();
+
+	static void publish_in_list(Type& type)
+	{
+		if (registry.is_list_stale.load(std::memory_order_relaxed))
+		{
+			rebuild_list(); // Before a new type can end up at the address of a removed one
+		}
+
+		TypeList* list = registry.list.load(std::memory_order_relaxed);
+		const size_t size = (list ? list->size.load(std::memory_order_relaxed) : 0);
+		if (list == nullptr || size == list->capacity)
+		{
+			auto grown = std::make_unique<TypeList>(std::max<size_t>(64, size * 2));
+			count_allocation(sizeof(TypeList) + grown->capacity * sizeof(Type*));
+			if (list)
+			{
+				std::copy_n(list->types.get(), size, grown->types.get());
+				list->retired_at = registry.list_rebuild_count;
+			}
+			grown->size.store(size, std::memory_order_relaxed);
+			list = registry.lists.emplace_back(std::move(grown)).get();
+			registry.list.store(list, std::memory_order_seq_cst); // See `rebuild_list`
+		}
+
+		list->types[size] = &type;
+		list->size.store(size + 1, std::memory_order_release);
+	}
+
+	// Returns false when the table needs to grow first
+	static bool try_publish_by_id(IdTable& table, Type& type)
+	{
+		const size_t mask = table.capacity - 1;
+		for (size_t i = static_cast<size_t>(type.id) & mask; ; i = (i + 1) & mask)
+		{
+			const TemplateTypeId key = table.keys[i].load(std::memory_order_relaxed);
+			if (key == type.id)
+			{
+				table.types[i].store(&type, std::memory_order_release); // A later registration wins
+				return true;
+			}
+			if (key == 0)
+			{
+				if ((table.count + 1) * 2 > table.capacity)
+				{
+					return false;
+				}
+				table.count++;
+				table.types[i].store(&type, std::memory_order_relaxed);
+				table.keys[i].store(type.id, std::memory_order_release); // Publishes the type too
+				return true;
+			}
+		}
+	}
+
+	// Drops the keys of removed types, when they take up most of the table
+	static bool try_compact(IdTable& table)
+	{
+		std::vector<Type*> types;
+		for (size_t i = 0; i < table.capacity; i++)
+		{
+			if (Type* type = table.types[i].load(std::memory_order_relaxed))
+			{
+				types.push_back(type);
+			}
+		}
+		if (types.size() * 4 > table.capacity)
+		{
+			return false;
+		}
+
+		const uint64_t version = table.version.load(std::memory_order_relaxed);
+		table.version.store(version + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release); // Lookups which see any of the changes below see the odd version
+		for (size_t i = 0; i < table.capacity; i++)
+		{
+			table.keys[i].store(0, std::memory_order_relaxed);
+			table.types[i].store(nullptr, std::memory_order_relaxed);
+		}
+		table.count = 0;
+		for (Type* type : types)
+		{
+			try_publish_by_id(table, *type);
+		}
+		table.version.store(version + 2, std::memory_order_release);
+		return true;
+	}
+
+	static void publish_by_id(Type& type)
+	{
+		assert(type.id != 0 && "Types need an id before they are added");
+
+		IdTable* table = registry.by_template_type_id.load(std::memory_order_relaxed);
+		if (table && (try_publish_by_id(*table, type) || (try_compact(*table) && try_publish_by_id(*table, type))))
+		{
+			return;
+		}
+
+		auto grown = std::make_unique<IdTable>(table ? table->capacity * 2 : 128);
+		count_allocation(sizeof(IdTable) + grown->capacity * (sizeof(std::atomic<TemplateTypeId>) + sizeof(std::atomic<Type*>)));
+		for (size_t i = 0; table && i < table->capacity; i++)
+		{
+			if (Type* existing = table->types[i].load(std::memory_order_relaxed))
+			{
+				try_publish_by_id(*grown, *existing);
+			}
+		}
+		try_publish_by_id(*grown, type);
+		table = registry.id_tables.emplace_back(std::move(grown)).get();
+		registry.by_template_type_id.store(table, std::memory_order_release);
+	}
+
+	// Returns false when the table needs to grow first
+	static bool try_publish_by_name(NameTable& table, Type& type)
+	{
+		const size_t mask = table.capacity - 1;
+		std::atomic<Type*>* removed_slot = nullptr; // Reused, but only once it's certain the name isn't further along
+		for (size_t i = std::hash<std::string_view>{}(type.name) & mask; ; i = (i + 1) & mask)
+		{
+			Type* existing = table.slots[i].load(std::memory_order_relaxed);
+			if (existing == &removed_type_marker)
+			{
+				removed_slot = (removed_slot ? removed_slot : &table.slots[i]);
+				continue;
+			}
+			if (existing == nullptr)
+			{
+				if (removed_slot)
+				{
+					removed_slot->store(&type, std::memory_order_release);
+					return true;
+				}
+				if ((table.count + 1) * 2 > table.capacity)
+				{
+					return false;
+				}
+				table.count++;
+				table.slots[i].store(&type, std::memory_order_release);
+				return true;
+			}
+			if (existing->name == type.name)
+			{
+				table.slots[i].store(&type, std::memory_order_release); // A later registration wins
+				return true;
+			}
+		}
+	}
+
+	static void publish_by_name(Type& type)
+	{
+		NameTable* table = registry.by_type_name.load(std::memory_order_relaxed);
+		if (table && try_publish_by_name(*table, type))
+		{
+			return;
+		}
+
+		auto grown = std::make_unique<NameTable>(table ? table->capacity * 2 : 128);
+		count_allocation(sizeof(NameTable) + grown->capacity * sizeof(std::atomic<Type*>));
+		for (size_t i = 0; table && i < table->capacity; i++)
+		{
+			Type* existing = table->slots[i].load(std::memory_order_relaxed);
+			if (existing != nullptr && existing != &removed_type_marker)
+			{
+				try_publish_by_name(*grown, *existing);
+			}
+		}
+		try_publish_by_name(*grown, type);
+		table = registry.name_tables.emplace_back(std::move(grown)).get();
+		registry.by_type_name.store(table, std::memory_order_release);
+	}
+
+	// Only removes the lookups which still lead to `type`, it could have been replaced by a later registration
+	static void unpublish(Type& type)
+	{
+		if (IdTable* table = registry.by_template_type_id.load(std::memory_order_relaxed))
+		{
+			const size_t mask = table->capacity - 1;
+			for (size_t i = static_cast<size_t>(type.id) & mask; ; i = (i + 1) & mask)
+			{
+				const TemplateTypeId key = table->keys[i].load(std::memory_order_relaxed);
+				if (key == type.id)
+				{
+					Type* expected = &type;
+					table->types[i].compare_exchange_strong(expected, nullptr, std::memory_order_release, std::memory_order_relaxed);
+					break;
+				}
+				if (key == 0)
+				{
+					break;
+				}
+			}
+		}
+
+		if (NameTable* table = registry.by_type_name.load(std::memory_order_relaxed))
+		{
+			const size_t mask = table->capacity - 1;
+			for (size_t i = std::hash<std::string_view>{}(type.name) & mask; ; i = (i + 1) & mask)
+			{
+				Type* existing = table->slots[i].load(std::memory_order_relaxed);
+				if (existing == nullptr)
+				{
+					break;
+				}
+				if (existing == &type)
+				{
+					table->slots[i].store(&removed_type_marker, std::memory_order_release);
+					break;
+				}
+			}
+		}
+
+		// Rebuilding the list here would make removal O(all types), it's rebuilt once it's needed again
+		registry.removed_types.insert(&type);
+		registry.is_list_stale.store(true, std::memory_order_release);
+	}
+
+	// Spans handed out by `get_types` stay valid until a module is removed, the removed types are in them. So lists
+	// which were replaced before the last rebuild aren't handed out anymore, and are reused or freed here. Unless a
+	// `get_types` call is just reading one (it loaded the list before the last rebuild published a new one), then 
+	// they are kept until the next rebuild.
+	static void rebuild_list()
+	{
+		TypeList* stale = registry.list.load(std::memory_order_relaxed);
+		const size_t stale_size = (stale ? stale->size.load(std::memory_order_relaxed) : 0);
+		const size_t capacity = std::max<size_t>(64, stale_size);
+
+		std::unique_ptr<TypeList> rebuilt;
+		if (registry.list_readers.load(std::memory_order_seq_cst) == 0)
+		{
+			for (auto& retired : registry.lists)
+			{
+				if (retired.get() != stale && retired->retired_at < registry.list_rebuild_count && !rebuilt && retired->capacity >= capacity)
+				{
+					rebuilt = std::move(retired);
+				}
+			}
+			std::erase_if(registry.lists, [stale](const std::unique_ptr<TypeList>& retired)
+			{
+				return retired == nullptr || (retired.get() != stale && retired->retired_at < registry.list_rebuild_count);
+			});
+		}
+		if (rebuilt == nullptr)
+		{
+			rebuilt = std::make_unique<TypeList>(capacity);
+			count_allocation(sizeof(TypeList) + rebuilt->capacity * sizeof(Type*));
+		}
+
+		size_t size = 0;
+		for (size_t i = 0; i < stale_size; i++)
+		{
+			if (!registry.removed_types.contains(stale->types[i]))
+			{
+				rebuilt->types[size++] = stale->types[i];
+			}
+		}
+		rebuilt->size.store(size, std::memory_order_relaxed);
+
+		if (stale)
+		{
+			stale->retired_at = registry.list_rebuild_count;
+		}
+		registry.list_rebuild_count++;
+		// Sequentially consistent with `list_readers`: a `get_types` call which isn't counted yet loads this list
+		registry.list.store(registry.lists.emplace_back(std::move(rebuilt)).get(), std::memory_order_seq_cst);
+		registry.removed_types.clear();
+		registry.is_list_stale.store(false, std::memory_order_release);
+	}
+
+	static bool has_contiguous_trivially_copyable_fields(std::span<const Field> fields)
+	{
+		if (fields.empty())
+		{
+			return false;
+		}
+
+		std::vector<const Field*> by_offset;
+		by_offset.reserve(fields.size());
+		for (auto& field : fields)
+		{
+			if (!field.is_trivially_copyable)
+			{
+				return false;
+			}
+			by_offset.push_back(&field);
+		}
+		std::sort(by_offset.begin(), by_offset.end(),
+			[](const Field* lhs, const Field* rhs) { return lhs->offset < rhs->offset; });
+
+		for (size_t i = 1; i < by_offset.size(); i++)
+		{
+			const Field& previous = *by_offset[i - 1];
+			const Field& current = *by_offset[i];
+
+			// Any gap could hold padding, but just as well an unreflected member, so we can't copy over it
+			if (current.offset != previous.offset + previous.size)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	static void resolve(Type& type)
+	{
+		if (type.resolve)
+		{
+			type.resolve(type);
+		}
+		for (auto& base : type.bases)
+		{
+			if (base.resolve)
+			{
+				base.resolve(base);
+			}
+		}
+		for (auto& field : type.fields)
+		{
+			if (field.details->resolve)
+			{
+				field.details->resolve(field);
+			}
+		}
+		for (auto& method : type.methods)
+		{
+			if (method.details->resolve)
+			{
+				method.details->resolve(method);
+			}
+		}
+		if (type.enumeration && type.enumeration->resolve)
+		{
+			type.enumeration->resolve(*type.enumeration);
+		}
+
+		type.has_contiguous_trivially_copyable_fields = has_contiguous_trivially_copyable_fields(type.fields);
+	}
+
+	// The type needs to stay at the same address, handed out pointers stay valid forever
+	static void publish(Type& type)
+	{
+		publish_by_id(type);
+		publish_by_name(type);
+		publish_in_list(type);
+	}
+
+	static void resolve_module(TypeRegistry::RegisteredModule& registered)
+	{
+		RegistrationProbe probe;
+		std::erase(registry.unresolved_modules, &registered);
+		registered.is_resolved = true;
+
+		// The module's static table is its arena, so nothing is allocated per type
+		for (auto& type : registered.module->types)
+		{
+			resolve(type);
+			publish(type);
+		}
+		count_resolved_module(*registered.module, probe);
+
+		registry.has_unresolved_modules.store(!registry.unresolved_modules.empty(), std::memory_order_release);
+	}
+
+	static void collect_registered_modules()
+	{
+		if (first_registered_module.load(std::memory_order_relaxed) == nullptr)
+		{
+			return;
+		}
+
+		// Set before `first_registered_module` looks empty to lookups, so they never skip the locked path too early
+		registry.has_unresolved_modules.store(true, std::memory_order_release);
+		Module* module = first_registered_module.exchange(nullptr, std::memory_order_acq_rel);
+		while (module != nullptr)
+		{
+			Module* next = module->next_registered;
+			module->next_registered = nullptr;
+
+			assert(std::ranges::is_sorted(module->types, {}, &Type::name) && "Module types need to be sorted by name");
+			auto [it, inserted] = registry.registered_modules.try_emplace(module, 
+				TypeRegistry::RegisteredModule{ .module = module, .generation = std::atomic_ref{ module->generation }.load(std::memory_order_relaxed) });
+			assert(inserted && "`add_module` links a module in only once until it's removed");
+			registry.unresolved_modules.push_back(&it->second);
+			module = next;
+		}
+	}
+
+	// Returns false when no unresolved module contains the type
+	static bool resolve_module_containing(std::string_view type_name)
+	{
+		collect_registered_modules();
+
+		for (auto* unresolved : registry.unresolved_modules)
+		{
+			auto types = unresolved->module->types;
+			auto it = std::ranges::lower_bound(types, type_name, {}, &Type::name);
+			if (it != types.end() && it->name == type_name)
+			{
+				resolve_module(*unresolved);
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	// Returns false when no unresolved module contains the type
+	static bool resolve_module_containing(TemplateTypeId type_id)
+	{
+		collect_registered_modules();
+
+		// Only the ids of the types are resolved here, which is a lot cheaper than resolving all their members
+		auto& module_by_id = registry.unresolved_module_by_template_type_id;
+		for (auto* unresolved : registry.unresolved_modules)
+		{
+			if (unresolved->ids_indexed)
+			{
+				continue;
+			}
+
+			for (auto& type : unresolved->module->types)
+			{
+				if (type.resolve)
+				{
+					type.resolve(type);
+				}
+				module_by_id[type.id] = unresolved->module;
+			}
+			unresolved->ids_indexed = true;
+		}
+
+		auto module_it = module_by_id.find(type_id);
+		if (module_it == module_by_id.end())
+		{
+			return false;
+		}
+
+		Module* module = module_it->second;
+		module_by_id.erase(module_it);
+		auto it = registry.registered_modules.find(module);
+		if (it == registry.registered_modules.end() || it->second.is_resolved)
+		{
+			return false; // Already resolved through a lookup by name
+		}
+
+		resolve_module(it->second);
+		return true;
+	}
+
+	static void resolve_all_modules()
+	{
+		collect_registered_modules();
+
+		while (!registry.unresolved_modules.empty())
+		{
+			resolve_module(*registry.unresolved_modules.back());
+		}
+	}
 
 	Type& add_type(Type&& type)
 	{
-		type_container.by_type_name[type.name] = type_container.types.size();
-		type_container.by_template_type_id[type.id] = type_container.types.size();
-		type_container.types.push_back(std::move(type));
-		return type_container.types.back();
+		// Resolved while holding the lock, like the types of modules, as resolving writes to data shared between
+		// types. The added type's members could be shared with an already published type too.
+		std::scoped_lock lock{ registry.mutex };
+		RegistrationProbe probe;
+		Type& added = registry.added_types.add(std::move(type));
+		resolve(added);
+		publish(added);
+		count_added_type(probe);
+		return added;
 	}
 
-	std::span<Type> Neat::get_types()
+	ModuleHandle add_module(Module& module)
 	{
-		return { type_container.types.begin(), type_container.types.end() };
+		// Already registered, it's either linked in or known to the registry. Linking it in again would make it point
+		// to itself, and reset its state in the registry. The generation is claimed from 0, so only one of several
+		// threads adding the same module links it in, and only once `remove_module` is done with it.
+		std::atomic_ref registered_generation{ module.generation };
+		uint32_t current = registered_generation.load(std::memory_order_acquire);
+		if (current != 0)
+		{
+			return { .module = &module, .generation = current };
+		}
+		const uint32_t generation = ++last_module_generation;
+		if (!registered_generation.compare_exchange_strong(current, generation, std::memory_order_acq_rel))
+		{
+			return { .module = &module, .generation = current }; // Added by another thread meanwhile
+		}
+
+		Module* first = first_registered_module.load(std::memory_order_relaxed);
+		do
+		{
+			module.next_registered = first;
+		} while (!first_registered_module.compare_exchange_weak(first, &module, std::memory_order_release, std::memory_order_relaxed));
+
+		return { .module = &module, .generation = generation };
 	}
 
-	Type* get_type(std::string_view type_name)
+	// Returns nullptr when the handle is stale. Needs to be called while holding `registry.mutex`.
+	static TypeRegistry::RegisteredModule* find_registered_module(ModuleHandle handle)
 	{
-		auto it = type_container.by_type_name.find(std::string{ type_name }); // TODO: Avoid allocation
-		if (it == type_container.by_type_name.end())
+		collect_registered_modules();
+
+		auto it = registry.registered_modules.find(handle.module);
+		if (it == registry.registered_modules.end() || it->second.generation != handle.generation)
 		{
 			return nullptr;
 		}
-		return &type_container.types[it->second];
+		return &it->second;
+	}
+
+	static bool depends_on(const Inheritance& inheritance, const std::unordered_set<TemplateTypeId>& type_ids)
+	{
+		return std::ranges::any_of(inheritance.bases, [&](const InheritedBase& base) { return type_ids.contains(base.base_id); });
+	}
+
+	// Drops what's cached for the removed types, and the inheritances and serialization plans which point into them.
+	// Those of other types are computed again when needed. Needs to be called while holding `registry.mutex`.
+	static void drop_cached_data(std::span<Type> removed_types)
+	{
+		Detail::drop_serialization_plans(removed_types);
+
+		std::unordered_set<TemplateTypeId> removed_ids;
+		for (auto& type : removed_types)
+		{
+			removed_ids.insert(type.id);
+			std::atomic_ref{ type.member_index }.store(nullptr, std::memory_order_relaxed); // The module could be added again
+			registry.member_indices.erase(&type);
+		}
+
+		for (auto it = registry.inheritances.begin(); it != registry.inheritances.end(); )
+		{
+			auto& [type, storage] = *it;
+			const bool is_removed = !std::less<>{}(type, removed_types.data()) && std::less<>{}(type, removed_types.data() + removed_types.size());
+			if (!is_removed && !depends_on(storage->inheritance, removed_ids))
+			{
+				++it;
+				continue;
+			}
+
+			std::atomic_ref{ type->inheritance }.store(nullptr, std::memory_order_release);
+			if (!is_removed)
+			{
+				registry.dropped_inheritances.push_back(std::move(storage));
+			}
+			it = registry.inheritances.erase(it);
+		}
+	}
+
+	bool remove_module(ModuleHandle handle)
+	{
+		if (TypeRegistry::is_registry_destroyed)
+		{
+			return false; // The process is exiting, nothing needs to be cleaned up anymore
+		}
+
+		std::scoped_lock lock{ registry.mutex };
+		TypeRegistry::RegisteredModule* registered = find_registered_module(handle);
+		if (registered == nullptr)
+		{
+			return false;
+		}
+
+		if (registered->is_resolved)
+		{
+			for (auto& type : registered->module->types)
+			{
+				unpublish(type);
+			}
+		}
+		else
+		{
+			std::erase(registry.unresolved_modules, registered);
+			auto& module_by_id = registry.unresolved_module_by_template_type_id;
+			for (auto& type : registered->module->types)
+			{
+				if (auto it = module_by_id.find(type.id); registered->ids_indexed && it != module_by_id.end() && it->second == registered->module)
+				{
+					module_by_id.erase(it);
+				}
+			}
+			registry.has_unresolved_modules.store(!registry.unresolved_modules.empty(), std::memory_order_release);
+		}
+
+		drop_cached_data(registered->module->types);
+		std::atomic_ref{ registered->module->generation }.store(0, std::memory_order_release); // So it can be added again
+		registry.registered_modules.erase(handle.module);
+		return true;
+	}
+
+	bool is_registered(ModuleHandle handle)
+	{
+		std::scoped_lock lock{ registry.mutex };
+		return find_registered_module(handle) != nullptr;
+	}
+
+	std::span<Type* const> get_types()
+	{
+		if (may_have_unresolved_modules() || registry.is_list_stale.load(std::memory_order_acquire))
+		{
+			std::scoped_lock lock{ registry.mutex };
+			resolve_all_modules();
+			if (registry.is_list_stale.load(std::memory_order_relaxed))
+			{
+				rebuild_list();
+			}
+		}
+
+		registry.list_readers.fetch_add(1, std::memory_order_seq_cst);
+		const TypeList* list = registry.list.load(std::memory_order_seq_cst);
+		std::span<Type* const> types;
+		if (list != nullptr)
+		{
+			types = { list->types.get(), list->size.load(std::memory_order_acquire) };
+		}
+		registry.list_readers.fetch_sub(1, std::memory_order_release);
+		return types;
+	}
+
+	static Type* find_or_resolve_type(std::string_view type_name)
+	{
+		Type* type = find_type(type_name);
+		if (type != nullptr || !may_have_unresolved_modules()) // Only pay for locking when the type could still be registered
+		{
+			return type;
+		}
+
+		std::scoped_lock lock{ registry.mutex };
+		type = find_type(type_name); // Another thread could have resolved it in the meantime
+		if (type == nullptr && resolve_module_containing(type_name))
+		{
+			type = find_type(type_name);
+		}
+		return type;
+	}
+
+	static Type* find_or_resolve_type(TemplateTypeId type_id)
+	{
+		Type* type;
+		if (try_find_type(type_id, type) && (type != nullptr || !may_have_unresolved_modules()))
+		{
+			return type;
+		}
+
+		std::scoped_lock lock{ registry.mutex };
+		type = find_type(type_id);
+		if (type == nullptr && resolve_module_containing(type_id))
+		{
+			type = find_type(type_id);
+		}
+		return type;
+	}
+
+	Type* get_type(std::string_view type_name)
+	{
+		Type* type = find_or_resolve_type(type_name);
+		count_lookup_by_name(type);
+		return type;
 	}
 
 	Type* get_type(TemplateTypeId type_id)
 	{
-		auto it = type_container.by_template_type_id.find(type_id);
-		if (it == type_container.by_template_type_id.end())
+		Type* type = find_or_resolve_type(type_id);
+		count_lookup_by_id(type);
+		return type;
+	}
+
+	bool Detail::enable_copy_construction(TemplateTypeId type_id, Type::CopyFunction copy_constructor)
+	{
+		Type* type = get_type(type_id);
+		if (type == nullptr)
+		{
+			return false;
+		}
+		std::atomic_ref{ type->copy_constructor }.store(copy_constructor, std::memory_order_release);
+		return true;
+	}
+
+	bool Detail::enable_move_construction(TemplateTypeId type_id, Type::MoveFunction move_constructor)
+	{
+		Type* type = get_type(type_id);
+		if (type == nullptr)
+		{
+			return false;
+		}
+		std::atomic_ref{ type->move_constructor }.store(move_constructor, std::memory_order_release);
+		return true;
+	}
+
+	Statistics get_statistics()
+	{
+		Statistics statistics;
+#ifdef NEAT_REFLECTION_INSTRUMENTATION
+		statistics.added_type_count = instrumentation.added_type_count.load(std::memory_order_relaxed);
+		statistics.added_type_bytes = instrumentation.added_type_bytes.load(std::memory_order_relaxed);
+		statistics.lookups_by_name = { .hits = instrumentation.name_hits.load(std::memory_order_relaxed), .misses = instrumentation.name_misses.load(std::memory_order_relaxed) };
+		statistics.lookups_by_id = { .hits = instrumentation.id_hits.load(std::memory_order_relaxed), .misses = instrumentation.id_misses.load(std::memory_order_relaxed) };
+
+		std::scoped_lock lock{ registry.mutex };
+		statistics.modules = instrumentation.modules;
+#endif
+		return statistics;
+	}
+
+	void reset_statistics()
+	{
+#ifdef NEAT_REFLECTION_INSTRUMENTATION
+		instrumentation.added_type_count = 0;
+		instrumentation.added_type_bytes = 0;
+		instrumentation.name_hits = 0;
+		instrumentation.name_misses = 0;
+		instrumentation.id_hits = 0;
+		instrumentation.id_misses = 0;
+
+		std::scoped_lock lock{ registry.mutex };
+		instrumentation.modules.clear(); // `allocated_bytes` keeps running, probes measure the difference
+#endif
+	}
+
+	// Same as `get_type`, but needs to be called while holding `registry.mutex`
+	static Type* get_type_locked(TemplateTypeId type_id)
+	{
+		Type* type = find_type(type_id);
+		if (type == nullptr && resolve_module_containing(type_id))
+		{
+			type = find_type(type_id);
+		}
+		return type;
+	}
+
+	static std::unique_ptr<InheritanceStorage> compute_inheritance(const Type& type)
+	{
+		std::vector<InheritedBase> found_bases; // Breadth first, so the nearest base is found first
+		std::vector<size_t> via_indices;
+		std::vector<const Type*> base_types; // nullptr when the base isn't registered
+		constexpr size_t no_index = SIZE_MAX;
+
+		const auto add_bases_of = [&](const Type& derived, size_t derived_index)
+		{
+			const InheritedBase* via = (derived_index == no_index ? nullptr : &found_bases[derived_index]);
+			for (auto& base : derived.bases)
+			{
+				if (std::ranges::find(found_bases, base.base_id, &InheritedBase::base_id) != found_bases.end())
+				{
+					continue;
+				}
+
+				found_bases.push_back({
+					.base_id = base.base_id,
+					.access = (via ? std::max(via->access, base.access) : base.access),
+					.has_fixed_offset = (via ? via->has_fixed_offset : true) && base.upcast != nullptr && !base.is_virtual,
+					.offset = (via ? via->offset : 0) + base.offset,
+					.base = &base,
+					.via = nullptr // Fixed up after sorting
+				});
+				via = (derived_index == no_index ? nullptr : &found_bases[derived_index]); // `found_bases` might have grown
+				via_indices.push_back(derived_index);
+				base_types.push_back(get_type_locked(base.base_id));
+			}
+		};
+
+		add_bases_of(type, no_index);
+		for (size_t i = 0; i < found_bases.size(); i++)
+		{
+			if (base_types[i] != nullptr)
+			{
+				add_bases_of(*base_types[i], i);
+			}
+		}
+
+		std::vector<size_t> sorted_indices(found_bases.size());
+		for (size_t i = 0; i < sorted_indices.size(); i++)
+		{
+			sorted_indices[i] = i;
+		}
+		std::ranges::sort(sorted_indices, {}, [&found_bases](size_t index) { return found_bases[index].base_id; });
+		std::vector<size_t> sorted_positions(found_bases.size());
+		for (size_t i = 0; i < sorted_indices.size(); i++)
+		{
+			sorted_positions[sorted_indices[i]] = i;
+		}
+
+		auto storage = std::make_unique<InheritanceStorage>();
+		auto& bases = storage->bases;
+		bases.reserve(found_bases.size());
+		for (size_t index : sorted_indices)
+		{
+			bases.push_back(found_bases[index]);
+		}
+		for (size_t i = 0; i < found_bases.size(); i++)
+		{
+			if (via_indices[i] != no_index)
+			{
+				bases[sorted_positions[i]].via = &bases[sorted_positions[via_indices[i]]];
+			}
+		}
+
+		auto& fields = storage->fields;
+		for (auto& field : type.fields)
+		{
+			fields.push_back({ .field = &field, .base = nullptr });
+		}
+		for (size_t i = 0; i < found_bases.size(); i++)
+		{
+			for (size_t j = 0; base_types[i] != nullptr && j < base_types[i]->fields.size(); j++)
+			{
+				fields.push_back({ .field = &base_types[i]->fields[j], .base = &bases[sorted_positions[i]] });
+			}
+		}
+
+		storage->inheritance = { .bases = bases, .fields = fields };
+		return storage;
+	}
+
+	const Inheritance& Type::get_inheritance() const
+	{
+		if (const Inheritance* cached = std::atomic_ref{ inheritance }.load(std::memory_order_acquire))
+		{
+			return *cached;
+		}
+
+		std::scoped_lock lock{ registry.mutex };
+		if (const Inheritance* cached = std::atomic_ref{ inheritance }.load(std::memory_order_relaxed)) // Computed by another thread meanwhile
+		{
+			return *cached;
+		}
+
+		auto& storage = registry.inheritances[this];
+		storage = compute_inheritance(*this);
+		const Inheritance* computed = &storage->inheritance;
+		std::atomic_ref{ inheritance }.store(computed, std::memory_order_release);
+		return *computed;
+	}
+
+	template<typename TMember>
+	static std::vector<const TMember*> build_member_table(std::span<TMember> members)
+	{
+		std::vector<const TMember*> slots(members.empty() ? 0 : std::bit_ceil(members.size() * 2));
+		const size_t mask = slots.size() - 1;
+		for (auto& member : members) // In declaration order, so the first overload comes first in its probe sequence
+		{
+			size_t i = std::hash<std::string_view>{}(member.name) & mask;
+			while (slots[i] != nullptr)
+			{
+				i = (i + 1) & mask;
+			}
+			slots[i] = &member;
+		}
+		return slots;
+	}
+
+	template<typename TMember>
+	static const TMember* find_member(std::span<const TMember* const> slots, std::string_view name)
+	{
+		if (slots.empty())
 		{
 			return nullptr;
 		}
-		return &type_container.types[it->second];
+
+		const size_t mask = slots.size() - 1;
+		for (size_t i = std::hash<std::string_view>{}(name) & mask; ; i = (i + 1) & mask)
+		{
+			const TMember* member = slots[i];
+			if (member == nullptr || member->name == name)
+			{
+				return member;
+			}
+		}
+	}
+
+	const MemberIndex& Type::get_member_index() const
+	{
+		if (const MemberIndex* cached = std::atomic_ref{ member_index }.load(std::memory_order_acquire))
+		{
+			return *cached;
+		}
+
+		std::scoped_lock lock{ registry.mutex };
+		if (const MemberIndex* cached = std::atomic_ref{ member_index }.load(std::memory_order_relaxed)) // Built by another thread meanwhile
+		{
+			return *cached;
+		}
+
+		auto& storage = *(registry.member_indices[this] = std::make_unique<MemberIndexStorage>());
+		storage.fields = build_member_table(fields);
+		storage.methods = build_member_table(methods);
+		storage.index = { .fields = storage.fields, .methods = storage.methods };
+		std::atomic_ref{ member_index }.store(&storage.index, std::memory_order_release);
+		return storage.index;
+	}
+
+	const Field* Type::find_field(std::string_view name) const
+	{
+		return find_member(get_member_index().fields, name);
+	}
+
+	const Method* Type::find_method(std::string_view name) const
+	{
+		return find_member(get_member_index().methods, name);
 	}
 }
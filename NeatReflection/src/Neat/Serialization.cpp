@@ -0,0 +1,266 @@
+#include "Neat/Serialization.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <cassert>
+
+
+namespace Neat
+{
+	// 64 bit FNV-1a, the hash has to stay the same across builds and platforms
+	class SchemaHasher
+	{
+	public:
+		void add(std::string_view text)
+		{
+			for (char character : text)
+			{
+				hash = (hash ^ static_cast<unsigned char>(character)) * prime;
+			}
+			hash = (hash ^ 0xFF) * prime; // Keeps "ab" + "c" apart from "a" + "bc"
+		}
+
+		void add(uint32_t value)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				hash = (hash ^ ((value >> (i * 8)) & 0xFF)) * prime;
+			}
+		}
+
+		void add(uint64_t value)
+		{
+			add(static_cast<uint32_t>(value));
+			add(static_cast<uint32_t>(value >> 32));
+		}
+
+		uint64_t get() const { return hash; }
+
+	private:
+		static constexpr uint64_t prime = 0x100000001B3;
+		uint64_t hash = 0xCBF29CE484222325;
+	};
+
+	struct PlanCompiler
+	{
+		SerializationPlan& plan;
+		std::vector<TemplateTypeId>& dependencies; // Bases and nested types, the plan changes when one of them is removed
+		SchemaHasher hasher{};
+
+		void add_run(uint32_t offset, uint32_t size)
+		{
+			if (!plan.runs.empty() && plan.runs.back().offset + plan.runs.back().size == offset)
+			{
+				plan.runs.back().size += size;
+			}
+			else
+			{
+				plan.runs.push_back({ .offset = offset, .size = size });
+			}
+			plan.payload_size += size;
+		}
+
+		void add_fields(const Type& type, uint32_t object_offset, const std::string& path)
+		{
+			const Inheritance& inheritance = type.get_inheritance();
+			for (auto& base : inheritance.bases)
+			{
+				dependencies.push_back(base.base_id);
+			}
+
+			for (auto& inherited : inheritance.fields)
+			{
+				const Field& field = *inherited.field;
+				const std::string field_path = path + std::string{ field.name };
+
+				if (inherited.base != nullptr && !inherited.base->has_fixed_offset)
+				{
+					plan.skipped_fields.push_back(field_path); // Behind a virtual base, its place isn't known up front
+					continue;
+				}
+				const uint32_t base_offset = (inherited.base ? static_cast<uint32_t>(inherited.base->offset) : 0);
+				const uint32_t offset = object_offset + base_offset + field.offset;
+
+				if (field.is_pointer)
+				{
+					plan.skipped_fields.push_back(field_path); // Copying it would just copy an address
+				}
+				else if (Type* field_type = get_type(field.type); field_type && field_type->enumeration == nullptr)
+				{
+					// Expanded even when it's trivially copyable, it could hold pointers, and its layout is part of the schema
+					dependencies.push_back(field_type->id);
+					hasher.add(field.name);
+					hasher.add(field_type->name);
+					add_fields(*field_type, offset, field_path + '.');
+					hasher.add("}");
+				}
+				else if (field.is_trivially_copyable)
+				{
+					hasher.add(field.name);
+					hasher.add(field.details->stable_type); // So that a field which changes its type, but not its size, changes the schema
+					hasher.add(field.size);
+					add_run(offset, field.size);
+				}
+				else
+				{
+					plan.skipped_fields.push_back(field_path);
+				}
+			}
+		}
+	};
+
+	// Plans are dropped with the module of their type. Those of other types which depended on a removed type are
+	// replaced, but kept, as references to them could still be in use.
+	struct PlanCache
+	{
+		struct CachedPlan
+		{
+			std::unique_ptr<SerializationPlan> plan;
+			std::vector<TemplateTypeId> dependencies;
+		};
+
+		std::shared_mutex mutex;
+		std::unordered_map<const Type*, CachedPlan> plans;
+		std::vector<std::unique_ptr<SerializationPlan>> replaced_plans;
+		uint64_t removal_count = 0; // So that a plan which was compiled while a module was removed is compiled again
+
+		~PlanCache() { is_destroyed = true; }
+		static constinit inline bool is_destroyed = false; // Modules can still be removed afterwards, during static destruction
+	};
+	static PlanCache plan_cache;
+
+
+	static SerializationPlan compile_plan(const Type& type, std::vector<TemplateTypeId>& dependencies)
+	{
+		SerializationPlan plan;
+		plan.type_id = type.id;
+
+		PlanCompiler compiler{ plan, dependencies };
+		compiler.hasher.add(type.name);
+		compiler.add_fields(type, 0, "");
+		plan.schema_hash = compiler.hasher.get();
+		return plan;
+	}
+
+	SerializationPlan compile_serialization_plan(const Type& type)
+	{
+		std::vector<TemplateTypeId> dependencies;
+		return compile_plan(type, dependencies);
+	}
+
+	const SerializationPlan& get_serialization_plan(const Type& type)
+	{
+		while (true)
+		{
+			uint64_t removal_count;
+			{
+				std::shared_lock lock{ plan_cache.mutex };
+				if (auto it = plan_cache.plans.find(&type); it != plan_cache.plans.end())
+				{
+					return *it->second.plan;
+				}
+				removal_count = plan_cache.removal_count;
+			}
+
+			// Compiled without holding the lock, it looks up other types
+			PlanCache::CachedPlan compiled;
+			compiled.plan = std::make_unique<SerializationPlan>(compile_plan(type, compiled.dependencies));
+
+			std::scoped_lock lock{ plan_cache.mutex };
+			if (plan_cache.removal_count != removal_count)
+			{
+				continue; // One of the types it used could have been removed
+			}
+			auto it = plan_cache.plans.try_emplace(&type, std::move(compiled)).first; // Unless compiled by another thread meanwhile
+			return *it->second.plan;
+		}
+	}
+
+	void Detail::drop_serialization_plans(std::span<Type> removed_types)
+	{
+		if (PlanCache::is_destroyed)
+		{
+			return;
+		}
+
+		std::unordered_set<TemplateTypeId> removed_ids;
+		for (auto& type : removed_types)
+		{
+			removed_ids.insert(type.id);
+		}
+
+		std::scoped_lock lock{ plan_cache.mutex };
+		plan_cache.removal_count++;
+		for (auto it = plan_cache.plans.begin(); it != plan_cache.plans.end(); )
+		{
+			auto& [type, cached] = *it;
+			const bool is_removed = !std::less<>{}(type, removed_types.data()) && std::less<>{}(type, removed_types.data() + removed_types.size());
+			if (!is_removed && std::ranges::none_of(cached.dependencies, [&](TemplateTypeId id) { return removed_ids.contains(id); }))
+			{
+				++it;
+				continue;
+			}
+
+			if (!is_removed)
+			{
+				plan_cache.replaced_plans.push_back(std::move(cached.plan));
+			}
+			it = plan_cache.plans.erase(it);
+		}
+	}
+
+	void serialize(const SerializationPlan& plan, const void* object, std::vector<std::byte>& out)
+	{
+		const size_t start = out.size();
+		out.resize(start + serialization_header_size + plan.payload_size);
+
+		std::byte* write = out.data() + start;
+		std::memcpy(write, &plan.schema_hash, sizeof(plan.schema_hash));
+		write += sizeof(plan.schema_hash);
+		std::memcpy(write, &plan.payload_size, sizeof(plan.payload_size));
+		write += sizeof(plan.payload_size);
+
+		const auto* read = static_cast<const std::byte*>(object);
+		for (auto& run : plan.runs)
+		{
+			std::memcpy(write, read + run.offset, run.size);
+			write += run.size;
+		}
+		assert(write == out.data() + out.size());
+	}
+
+	bool deserialize(const SerializationPlan& plan, void* object, std::span<const std::byte>& in)
+	{
+		if (in.size() < serialization_header_size)
+		{
+			return false;
+		}
+
+		uint64_t schema_hash;
+		uint32_t payload_size;
+		std::memcpy(&schema_hash, in.data(), sizeof(schema_hash));
+		std::memcpy(&payload_size, in.data() + sizeof(schema_hash), sizeof(payload_size));
+		if (schema_hash != plan.schema_hash || payload_size != plan.payload_size || in.size() - serialization_header_size < payload_size)
+		{
+			return false;
+		}
+
+		const std::byte* read = in.data() + serialization_header_size;
+		auto* write = static_cast<std::byte*>(object);
+		for (auto& run : plan.runs)
+		{
+			std::memcpy(write + run.offset, read, run.size);
+			read += run.size;
+		}
+
+		in = in.subspan(serialization_header_size + payload_size);
+		return true;
+	}
+}
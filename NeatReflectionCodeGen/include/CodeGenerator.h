@@ -1,10 +1,20 @@
 #pragma once
 #include "Neat/Reflection.h"
+#include "DatabaseWriter.h"
+#include "ModuleSet.h"
+#include "Profiler.h"
 
 #include <ostream>
+#include <iterator>
 #include <string>
 #include <string_view>
 #include <optional>
+#include <map>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
 
 #include "ifc/FileFwd.h"
 #include "ifc/DeclarationFwd.h"
@@ -13,30 +23,54 @@
 #include "ifc/TypeFwd.h"
 
 
+// Bump this whenever the generated code changes, so outputs of an older version are regenerated
+constexpr std::string_view CODE_GENERATOR_VERSION = "7";
+
 class CodeGenerator
 {
 public:
-	CodeGenerator(ifc::File& file);
+	// Declarations imported from other modules (`DeclSort::Reference`) can only be followed with a `module_set`.
+	// Times and counts are recorded in `profiler`, when given. The rendered types are also added to `database`, when given.
+	CodeGenerator(ifc::File& file, ModuleSet* module_set = nullptr, Profiler* profiler = nullptr, DatabaseWriter* database = nullptr);
 
-	void write_cpp_file(std::ostream& out);
+	// Types are rendered on `job_count` threads when `file_bytes`, the data `file` was loaded from, is given. Every
+	// thread reads it through an `ifc::File` of its own, so `file` is never read from multiple threads.
+	// The output is the same for any job count, and is written as the types are rendered. So besides the type entries,
+	// only the types rendered ahead of those being written are held in memory: a few dozen per thread.
+	void write_cpp_file(std::ostream& out, size_t job_count = 1, std::span<const std::byte> file_bytes = {});
 
 private:
+	friend class ModuleSet;
+
 	void scan(ifc::Sequence scope_desc);
 	void scan(ifc::DeclIndex decl);
 	void scan(const ifc::ScopeDeclaration& scope_decl, ifc::DeclIndex index);
 
-	void render(const ifc::ScopeDeclaration& scope_decl, ifc::DeclIndex index);
+	void render(ifc::DeclIndex index, size_t queue_index); // The type at `queue_index` of `render_queue`
+	void render_in_parallel(size_t job_count, std::span<const std::byte> file_bytes);
+	// The names of the type's tables start with `var_name`
+	void render(const ifc::ScopeDeclaration& scope_decl, ifc::DeclIndex index, std::string_view var_name);
 	struct TypeMembers { std::string fields, methods; };
-	TypeMembers render_members(std::string_view object, std::string_view type_variable, const ifc::ScopeDeclaration& scope_decl, bool reflect_private_members);
-	std::string render_bases(const ifc::ScopeDeclaration& scope_decl);
+	// The members and bases are also described in `database_type`, when given
+	TypeMembers render_members(std::string_view object, std::string_view type_variable, const ifc::ScopeDeclaration& scope_decl, bool reflect_private_members,
+		DatabaseWriter::Type* database_type = nullptr);
+	std::string render_bases(std::string_view object, const ifc::ScopeDeclaration& scope_decl, DatabaseWriter::Type* database_type = nullptr);
+	void render_enum(ifc::DeclIndex index, std::string_view var_name);
 	
-	std::string render_full_typename(ifc::TypeIndex type_index);
+	// Memoized, the same types and scopes are rendered for many members. 
+	// The references stay valid for the lifetime of the CodeGenerator.
+	const std::string& render_full_typename(ifc::TypeIndex type_index);
+	const std::string& render_namespace(ifc::DeclIndex index);
+
+	std::string render_full_typename_uncached(ifc::TypeIndex type_index);
 	std::string render_full_typename(const ifc::FundamentalType& type);
 	std::string render_full_typename(const ifc::TupleType& types);
+	std::vector<std::string> render_typenames(ifc::TypeIndex type_index); // One per element of a tuple
 
 	std::string render_refered_declaration(const ifc::DeclIndex& decl_index);
+	std::string render_qualified_name(ifc::DeclIndex index);
 
-	std::string render_namespace(ifc::DeclIndex index);
+	std::string render_namespace_uncached(ifc::DeclIndex index);
 
 	std::string render(ifc::Qualifiers qualifiers);
 	std::string_view render(Neat::Access access);
@@ -47,18 +81,34 @@ private:
 	template<typename T>
 	bool is_member_publicly_accessible(const T& member_declaration, ifc::TypeBasis type, bool reflects_private_members);
 	bool reflects_private_members(ifc::DeclIndex type_decl_index);
+	bool is_reflect_private_members_function(ifc::DeclIndex decl_index, ifc::TypeIndex type_index);
 	bool is_type_exported(ifc::TypeIndex);
 	bool is_type_exported(ifc::DeclIndex);
 
+	const ModuleSet::ImportedDeclaration& resolve_imported(ifc::DeclIndex reference);
+
 private:
 	ifc::File& file;
-	std::string code;
+	ModuleSet* module_set;
+	Profiler* profiler;
+	DatabaseWriter* database;
+	std::ostreambuf_iterator<char> code{ nullptr }; // Output of `write_cpp_file`, the member tables of all types are streamed into it
+	std::vector<ifc::DeclIndex> render_queue; // Classes, structs and enums found by `scan`, in the order they are written
+	std::map<std::string, std::string> type_entries; // Type name to its `Type::create`. Sorted by name, as `Neat::Module` requires
+
+	// Keyed by `cache_key`. Node based, so references to the strings stay valid while inserting.
+	std::unordered_map<uint64_t, std::string> full_typename_cache;
+	std::unordered_map<uint64_t, std::string> namespace_cache;
+	std::optional<uint64_t> reflect_private_members_function; // Once found, other friends are compared by index
 };
 
+// Unique per index within one ifc file, combines the sort and the index
+template<typename TIndex>
+uint64_t cache_key(TIndex index);
+
 std::optional<Neat::Access> convert(ifc::Access);
 std::string_view get_user_type_name(const ifc::File& file, ifc::NameIndex name);
 std::string replace_all_copy(std::string str, std::string_view target, std::string_view replacement);
-std::string to_snake_case(std::string_view type_name);
 
 // Inline Implementation
 #include "ContextualException.h"
@@ -98,4 +148,10 @@ bool CodeGenerator::is_member_publicly_accessible(const T& member_declaration, i
 	const Neat::Access member_access = convert(member_declaration.access).value_or(default_access);
 
 	return (member_access == Neat::Access::Public || reflects_private_members);
-}
\ No newline at end of file
+}
+
+template<typename TIndex>
+uint64_t cache_key(TIndex index)
+{
+	return (static_cast<uint64_t>(magic_enum::enum_integer(index.sort())) << 32) | static_cast<uint64_t>(index.index);
+}
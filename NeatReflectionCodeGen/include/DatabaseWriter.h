@@ -0,0 +1,61 @@
+#pragma once
+#include "Neat/Reflection.h"
+#include "Neat/Database.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+// Collects the reflected types of one module, and writes them as a reflection database (see `Neat/Database.h`)
+class DatabaseWriter
+{
+public:
+	struct Base
+	{
+		std::string name; // Fully qualified, like all type names
+		Neat::Access access;
+	};
+
+	struct Field
+	{
+		std::string name;
+		std::string type_name;
+		Neat::Access access;
+	};
+
+	struct Method
+	{
+		std::string name;
+		std::string return_type_name;
+		std::vector<std::string> argument_type_names;
+		Neat::Access access;
+	};
+
+	struct Enumerator
+	{
+		std::string name;
+		int64_t value;
+	};
+
+	struct Type
+	{
+		std::string name;
+		Neat::DatabaseFormat::TypeKind kind = Neat::DatabaseFormat::TypeKind::Class;
+		std::vector<Base> bases;
+		std::vector<Field> fields;
+		std::vector<Method> methods;
+		std::vector<Enumerator> enumerators; // Of enums, in the order they're declared
+	};
+
+	// Modifiers
+	void add_type(Type type);
+	void add_types(DatabaseWriter&& other); // Appends the types of `other`, in their order
+
+	// Accessors
+	[[nodiscard]] std::string write(std::string_view module_name) const; // Returns the content of the file
+
+private:
+	std::vector<Type> types;
+};
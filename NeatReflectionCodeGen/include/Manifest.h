@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+
+
+// Remembers from which input each output file was generated, so unchanged inputs don't have to be converted again.
+// Stored as a small text file. It's discarded entirely when it was written by a different generator version.
+class Manifest
+{
+public:
+	// Constructors
+	Manifest(std::filesystem::path path); // Loads the manifest, starts out empty when it doesn't exist or can't be read
+
+	// Modifiers
+	void set(const std::filesystem::path& output_file, uint64_t input_hash);
+	void remove(const std::filesystem::path& output_file);
+	bool save() const;
+
+	// Accessors
+	[[nodiscard]] bool is_up_to_date(const std::filesystem::path& output_file, uint64_t input_hash) const;
+
+private:
+	std::filesystem::path path;
+	std::unordered_map<std::string, uint64_t> input_hash_by_output_file;
+
+	mutable std::mutex mutex; // Files are converted in parallel
+};
+
+// 64 bit FNV-1a
+[[nodiscard]] uint64_t hash_bytes(std::span<const std::byte> bytes);
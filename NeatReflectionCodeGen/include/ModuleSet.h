@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ifc/FileFwd.h"
+#include "ifc/DeclarationFwd.h"
+#include "ifc/Environment.h"
+
+class CodeGenerator;
+
+
+// All module interfaces (.ifc files) of one target, loaded together so declarations one module imports from another
+// (`DeclSort::Reference`) can be followed. Every imported declaration is resolved once for the whole set, no matter
+// how many modules refer to it.
+class ModuleSet
+{
+public:
+	struct ImportedDeclaration
+	{
+		std::string full_name; // Including the namespace
+		bool is_exported = false;
+	};
+
+	// How the files are loaded. Mapped files can't be written by the compiler on Windows, so a set which is kept
+	// around while the target is built again needs to read them into memory instead.
+	enum class FileAccess
+	{
+		Map,
+		Read
+	};
+
+	// Constructors
+	ModuleSet(std::span<const std::filesystem::path> ifc_files, FileAccess file_access = FileAccess::Map); // Throws a ContextualException when a file can't be loaded
+	~ModuleSet();
+
+	// Accessors
+	[[nodiscard]] uint64_t get_input_hash() const; // Changes whenever any of the files changes
+
+	// Thread safe. Throws a ContextualException when the module isn't part of the set.
+	const ImportedDeclaration& resolve(std::string_view module_name, ifc::DeclIndex index);
+
+private:
+	struct Module
+	{
+		std::filesystem::path path;
+		ifc::Environment::BlobHolderPtr blob;
+		std::unique_ptr<ifc::File> file;
+		std::unique_ptr<CodeGenerator> renderer; // Only created once a declaration of the module is resolved
+	};
+	std::vector<std::unique_ptr<Module>> modules;
+	std::unordered_map<std::string, Module*> module_by_name;
+	uint64_t input_hash = 0;
+
+	// Keyed by the module and the `cache_key` of the declaration
+	std::unordered_map<const Module*, std::unordered_map<uint64_t, ImportedDeclaration>> resolved_declarations;
+
+	std::recursive_mutex mutex; // Resolving can import further, from a module which reexports a declaration
+};
+
+// The name of the module interface, `primary:partition` for partitions
+[[nodiscard]] std::string get_module_name(const ifc::File& file);
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <streambuf>
+#include <string_view>
+#include <vector>
+
+class Profiler;
+
+
+// Stream buffer which only replaces `path` when the streamed content differs from what's in the file already,
+// so build systems don't recompile outputs which didn't change. The content is compared chunk by chunk while 
+// it's streamed, so memory use stays bounded regardless of the size of the output.
+// 
+// Nothing is changed until `commit` is called, so an exception halfway leaves the existing file intact.
+class OutputFile : public std::streambuf
+{
+public:
+	// Constructors
+	OutputFile(std::filesystem::path path, Profiler* profiler = nullptr); // The file access is timed as `Phase::Write`
+	~OutputFile() override;
+
+	OutputFile(const OutputFile&) = delete;
+	OutputFile& operator=(const OutputFile&) = delete;
+
+	// Modifiers
+	bool commit(); // Returns false when the file couldn't be written
+
+protected:
+	int_type overflow(int_type character) override;
+	int sync() override;
+
+private:
+	bool flush_buffer();
+	bool start_writing(); // Switches from comparing to writing to `temporary_path`, after copying what matched so far
+
+private:
+	std::filesystem::path path;
+	std::filesystem::path temporary_path;
+
+	std::ifstream existing_file; // Only open while everything matched so far
+	std::ofstream temporary_file; // Only open after a difference was found
+	std::streamsize matched_size = 0;
+	bool failed = false;
+	Profiler* profiler;
+
+	static constexpr size_t buffer_size = 64 * 1024;
+	std::vector<char> buffer; // Not inline, to keep big buffers off the (worker thread) stacks
+	std::vector<char> existing_buffer;
+};
+
+// Returns false when the file couldn't be written
+bool write_file_if_changed(const std::filesystem::path& file, std::string_view content);
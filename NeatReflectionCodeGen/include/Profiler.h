@@ -0,0 +1,80 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+
+// Measures where the time goes while converting one file, and counts what was generated.
+// Not thread safe, every file that is converted gets its own.
+class Profiler
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	enum class Phase : uint8_t { Load, Scan, Render, Write };
+	static constexpr size_t phase_count = 4;
+
+	struct Event
+	{
+		Phase phase;
+		Clock::time_point start;
+		Clock::duration duration; // Including nested zones
+	};
+
+	// Times `phase` until it's destroyed. Time spent in nested zones only counts towards their own phase.
+	// Does nothing when `profiler` is nullptr, so it can be left in unconditionally.
+	class Zone
+	{
+	public:
+		Zone(Profiler* profiler, Phase phase);
+		~Zone();
+
+		Zone(const Zone&) = delete;
+		Zone& operator=(const Zone&) = delete;
+
+	private:
+		Profiler* profiler;
+	};
+
+	// Constructors
+	Profiler(std::string file);
+
+	// Data
+	std::string file;
+	std::thread::id thread; // Which converted the file
+	std::array<Clock::duration, phase_count> phase_times{}; // Excluding nested zones, indexed by phase
+	size_t type_count = 0;
+	size_t field_count = 0;
+	size_t method_count = 0;
+	size_t unsupported_type_count = 0; // Distinct types which were rendered as `<UNSUPPORTED_TYPE>`
+	std::vector<Event> events;
+
+private:
+	void begin(Phase phase);
+	void end();
+
+	struct ActiveZone
+	{
+		Phase phase;
+		Clock::time_point start;
+		Clock::time_point resumed; // Last time a nested zone ended
+	};
+	std::vector<ActiveZone> active_zones;
+};
+
+[[nodiscard]] std::string_view to_string(Profiler::Phase phase);
+
+// One line per file, slowest first so the worst modules are on top, followed by the totals
+void print_statistics(std::ostream& out, std::span<const Profiler> profiles);
+
+// In Chrome's trace event format, which can be opened in chrome://tracing or https://ui.perfetto.dev
+// Returns false when the file couldn't be written.
+bool write_chrome_trace(const std::filesystem::path& file, std::span<const Profiler> profiles);
@@ -6,7 +6,13 @@
 #include <cassert>
 #include <cctype>
 #include <algorithm>
+#include <condition_variable>
+#include <exception>
 #include <iostream>
+#include <iterator>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 #include "ifc/Declaration.h"
 #include "ifc/File.h"
@@ -16,14 +22,18 @@
 #include "magic_enum.hpp"
 
 
-CodeGenerator::CodeGenerator(ifc::File& file)
+CodeGenerator::CodeGenerator(ifc::File& file, ModuleSet* module_set, Profiler* profiler, DatabaseWriter* database)
 	: file(file)
+	, module_set(module_set)
+	, profiler(profiler)
+	, database(database)
 {
-	code.reserve(1024);
 }
 
-void CodeGenerator::write_cpp_file(std::ostream& out)
+void CodeGenerator::write_cpp_file(std::ostream& out, size_t job_count, std::span<const std::byte> file_bytes)
 {
+	Profiler::Zone zone{ profiler, Profiler::Phase::Scan };
+
 	if (file.header().unit.sort() != ifc::UnitSort::Primary) // For now
 	{
 		throw ContextualException("Currently the tool only supports primary module fragments (originating from a .ixx file from MSVC for example).");
@@ -31,10 +41,12 @@ void CodeGenerator::write_cpp_file(std::ostream& out)
 
 	auto unit_index = file.header().unit.index;
 	const auto module_name = file.get_string(ifc::TextOffset{ unit_index });
-	
-	scan(file.global_scope());
-	
-	out << std::format(
+
+	// The member tables are streamed straight to `out` while scanning, only the (small) type entries are kept 
+	// around until the end. So the output is never held in memory completely.
+	code = std::ostreambuf_iterator<char>{ out };
+
+	std::format_to(code,
 R"(// ================================================================================
 //                      AUTO GENERATED REFLECTION DATA FILE 
 //                    Generated by: NeatReflectionCodeGen.exe
@@ -50,17 +62,57 @@ import {0};
 
 namespace Neat
 {{
+	static constinit ModuleHandle reflected_module_handle{{}};
+
 	static void reflect_private_members()
 	{{
-{1}
+)", module_name);
+
+	// Finding the types is cheap, rendering them is where the time goes. So only rendering is spread over threads.
+	render_queue.clear();
+	scan(file.global_scope());
+	if (job_count > 1 && !file_bytes.empty() && render_queue.size() > 1)
+	{
+		render_in_parallel(job_count, file_bytes);
+	}
+	else
+	{
+		for (size_t i = 0; i < render_queue.size(); i++)
+		{
+			render(render_queue[i], i);
+		}
+	}
+
+	// Everything is emitted as `constinit` tables, so the only thing that runs during static initialisation
+	// is linking the module into the registry. The tables live inside `reflect_private_members` so they are 
+	// allowed to point to private members. Zero sized arrays aren't allowed, so an empty module gets an empty span.
+	const std::string_view types_table = (type_entries.empty() ? "{}" : "types");
+	if (!type_entries.empty())
+	{
+		out << "\n		static constinit Type types[] = {\n";
+		for (auto& [type_name, type_entry] : type_entries)
+		{
+			out << type_entry;
+		}
+		out << "		};\n";
+	}
+
+	std::format_to(code, R"(
+		static constinit Module reflected_module{{ "{0}", {1} }};
+		reflected_module_handle = add_module(reflected_module);
 	}}
 
 	namespace Detail
 	{{
-		struct Register{{ Register(){{ Neat::reflect_private_members(); }} }};
+		// Removes the types again when they are unloaded with their DLL
+		struct Register
+		{{
+			Register() {{ Neat::reflect_private_members(); }}
+			~Register() {{ Neat::remove_module(reflected_module_handle); }}
+		}};
 		static Register neat_reflection_data_initialiser{{ }};
 	}}
-}})", module_name, code);
+}})", module_name, types_table);
 
 	out.flush();
 }
@@ -81,6 +133,9 @@ void CodeGenerator::scan(ifc::DeclIndex decl)
 	case ifc::DeclSort::Scope:
 		scan(ifc::get_scope(file, decl), decl);
 		break;
+	case ifc::DeclSort::Enumeration:
+		render_queue.push_back(decl);
+		break;
 	}
 }
 
@@ -90,9 +145,7 @@ void CodeGenerator::scan(const ifc::ScopeDeclaration& scope_decl, ifc::DeclIndex
 	{
 	case ifc::TypeBasis::Class:
 	case ifc::TypeBasis::Struct:
-		{
-			render(scope_decl, index);
-		}
+		render_queue.push_back(index);
 		break;
 	case ifc::TypeBasis::Union:
 		// TODO: Implement at some point
@@ -103,32 +156,249 @@ void CodeGenerator::scan(const ifc::ScopeDeclaration& scope_decl, ifc::DeclIndex
 	}
 }
 
-void CodeGenerator::render(const ifc::ScopeDeclaration& scope_decl, ifc::DeclIndex index)
+void CodeGenerator::render(ifc::DeclIndex index, size_t queue_index)
+{
+	// Named after the place in the queue rather than the type, so the names can't collide with those of other types
+	// (like `FooBar` and `foo_bar`), and are the same for any job count
+	const auto var_name = std::format("type_{}_", queue_index);
+	if (index.sort() == ifc::DeclSort::Enumeration)
+	{
+		render_enum(index, var_name);
+	}
+	else
+	{
+		render(ifc::get_scope(file, index), index, var_name);
+	}
+}
+
+void CodeGenerator::render_in_parallel(size_t job_count, std::span<const std::byte> file_bytes)
+{
+	// Consecutive types of the queue, rendered into a buffer of their own. The buffers are written in order as soon as
+	// they're complete, so the output is the same as when rendering serially. Only a few chunks are rendered ahead of
+	// the one being written, so a module is never held in memory completely. There are several chunks per thread, so
+	// a few huge types can't keep one thread busy while the others are idle.
+	struct Chunk
+	{
+		std::span<const ifc::DeclIndex> types;
+		size_t first_index; // Of its first type in `render_queue`
+		std::ostringstream code;
+		std::map<std::string, std::string> type_entries;
+		std::optional<DatabaseWriter> database;
+		std::exception_ptr exception;
+		bool is_rendered = false;
+	};
+	constexpr size_t max_chunk_size = 64; // Types
+	constexpr size_t chunks_ahead_per_job = 4;
+
+	job_count = std::min(job_count, render_queue.size());
+	const size_t chunk_size = std::clamp((render_queue.size() + job_count * 8 - 1) / (job_count * 8), size_t{ 1 }, max_chunk_size);
+	std::vector<Chunk> chunks((render_queue.size() + chunk_size - 1) / chunk_size);
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		chunks[i].types = std::span{ render_queue }.subspan(i * chunk_size, std::min(chunk_size, render_queue.size() - i * chunk_size));
+		chunks[i].first_index = i * chunk_size;
+	}
+
+	// Every thread counts into its own profiler, the waiting time on this thread is what rendering took
+	std::vector<Profiler> worker_profiles;
+	if (profiler)
+	{
+		worker_profiles.reserve(job_count);
+		for (size_t i = 0; i < job_count; i++)
+		{
+			worker_profiles.emplace_back(profiler->file);
+		}
+	}
+
+	std::mutex mutex;
+	std::condition_variable chunk_rendered; // Waited on by this thread
+	std::condition_variable chunk_written; // Waited on by workers which are too far ahead
+	size_t next_chunk_index = 0;
+	size_t written_count = 0;
+	bool stopped = false; // After a failure, the output is thrown away anyway
+
+	const auto render_chunks = [&](size_t worker_index)
+	{
+		std::optional<ifc::File> worker_file;
+		std::optional<CodeGenerator> worker;
+		while (true)
+		{
+			size_t i;
+			{
+				std::unique_lock lock{ mutex };
+				chunk_written.wait(lock, [&]() { return stopped || next_chunk_index < written_count + job_count * chunks_ahead_per_job; });
+				if (stopped || next_chunk_index == chunks.size())
+				{
+					return;
+				}
+				i = next_chunk_index++;
+			}
+
+			auto& chunk = chunks[i];
+			try
+			{
+				if (!worker) // Its caches are kept for the following chunks
+				{
+					worker_file.emplace(file_bytes);
+					worker.emplace(*worker_file, module_set, profiler ? &worker_profiles[worker_index] : nullptr);
+				}
+
+				if (database)
+				{
+					chunk.database.emplace();
+				}
+				worker->code = std::ostreambuf_iterator<char>{ chunk.code };
+				worker->database = (chunk.database ? &*chunk.database : nullptr);
+				for (size_t j = 0; j < chunk.types.size(); j++)
+				{
+					worker->render(chunk.types[j], chunk.first_index + j);
+				}
+				chunk.type_entries = std::move(worker->type_entries);
+				worker->type_entries.clear();
+			}
+			catch (...)
+			{
+				chunk.exception = std::current_exception();
+			}
+
+			{
+				std::scoped_lock lock{ mutex };
+				chunk.is_rendered = true;
+				stopped = (stopped || chunk.exception); // The chunks before it are already being rendered
+			}
+			chunk_rendered.notify_one();
+			if (chunk.exception)
+			{
+				chunk_written.notify_all();
+			}
+		}
+	};
+
+	std::exception_ptr exception;
+	{
+		Profiler::Zone zone{ profiler, Profiler::Phase::Render };
+		std::vector<std::jthread> workers;
+		workers.reserve(job_count);
+		for (size_t i = 0; i < job_count; i++)
+		{
+			workers.emplace_back(render_chunks, i);
+		}
+
+		try
+		{
+			for (auto& chunk : chunks)
+			{
+				{
+					std::unique_lock lock{ mutex };
+					chunk_rendered.wait(lock, [&]() { return chunk.is_rendered; });
+				}
+				if (chunk.exception)
+				{
+					std::rethrow_exception(chunk.exception);
+				}
+
+				// Moved out of the stream and freed right away, only the (small) type entries are kept until the end
+				const auto chunk_code = std::move(chunk.code).str();
+				code = std::copy(chunk_code.begin(), chunk_code.end(), code);
+				type_entries.merge(chunk.type_entries);
+				if (chunk.database)
+				{
+					database->add_types(std::move(*chunk.database));
+					chunk.database.reset();
+				}
+
+				{
+					std::scoped_lock lock{ mutex };
+					written_count++;
+				}
+				chunk_written.notify_all();
+			}
+		}
+		catch (...)
+		{
+			exception = std::current_exception();
+		}
+
+		{
+			std::scoped_lock lock{ mutex };
+			stopped = true;
+		}
+		chunk_written.notify_all();
+	} // jthreads join here
+
+	if (exception)
+	{
+		std::rethrow_exception(exception);
+	}
+
+	for (auto& worker_profile : worker_profiles)
+	{
+		profiler->type_count += worker_profile.type_count;
+		profiler->field_count += worker_profile.field_count;
+		profiler->method_count += worker_profile.method_count;
+		profiler->unsupported_type_count += worker_profile.unsupported_type_count; // Can count a type once per thread
+	}
+}
+
+void CodeGenerator::render(const ifc::ScopeDeclaration& scope_decl, ifc::DeclIndex index, std::string_view var_name)
 {
 	if(!is_type_exported(index))
 	{
 		return;
 	}
 
+	Profiler::Zone zone{ profiler, Profiler::Phase::Render };
+
 	const auto type_name = render_namespace(index) + std::string{get_user_type_name(file, scope_decl.name)};
-	const auto var_name = to_snake_case(type_name) + '_';
 	const bool reflect_privates = reflects_private_members(index);
-	const auto [fields, methods] = render_members(type_name, var_name, scope_decl, reflect_privates);
-	const auto bases = render_bases(scope_decl);
-
-	code += std::format(R"(add_type({{ "{1}", get_id<{1}>(),
-	{{ {2} }},
-	{{ {3} }},
-	{{ {4} }}
-}});
-)", var_name, type_name, bases, fields, methods);
+	std::optional<DatabaseWriter::Type> database_type;
+	if (database)
+	{
+		database_type.emplace().name = type_name;
+	}
+	const auto [fields, methods] = render_members(type_name, var_name, scope_decl, reflect_privates, database_type ? &*database_type : nullptr);
+	const auto bases = render_bases(type_name, scope_decl, database_type ? &*database_type : nullptr);
+
+	// Zero sized arrays aren't allowed, so empty members are passed as empty spans
+	const auto render_table = [this, var_name](std::string_view table_type, std::string_view table_name, const std::string& entries) -> std::string
+	{
+		if (entries.empty())
+		{
+			return "{}";
+		}
+
+		auto table_variable = std::format("{0}{1}", var_name, table_name);
+		std::format_to(code, R"(		static constinit {0} {1}[] = {{ {2}}};
+)", table_type, table_variable, entries);
+		return table_variable;
+	};
+
+	const auto bases_table = render_table("BaseClass", "bases", bases);
+	const auto fields_table = render_table("Field", "fields", fields);
+	const auto methods_table = render_table("Method", "methods", methods);
+
+	if (profiler)
+	{
+		profiler->type_count++;
+	}
+	type_entries[type_name] = std::format(R"(			Type::create<{0}>("{0}", {1}, {2}, {3}),
+)", type_name, bases_table, fields_table, methods_table);
+
+	if (database_type)
+	{
+		database->add_type(std::move(*database_type));
+	}
 }
 
-CodeGenerator::TypeMembers CodeGenerator::render_members(std::string_view type_name, std::string_view type_variable, const ifc::ScopeDeclaration& scope_decl, bool reflect_private_members)
+CodeGenerator::TypeMembers CodeGenerator::render_members(std::string_view type_name, std::string_view type_variable, const ifc::ScopeDeclaration& scope_decl, bool reflect_private_members,
+	DatabaseWriter::Type* database_type)
 {
 	std::string fields;
 	std::string methods;
 
+	const auto type_kind = ifc::get_kind(scope_decl, file);
+	const auto default_access = (type_kind == ifc::TypeBasis::Class ? Neat::Access::Private : Neat::Access::Public);
+
 	auto scope_descriptor = file.scope_descriptors()[scope_decl.initializer];
 	auto declarations = ifc::get_declarations(file, scope_descriptor);
 	for (auto& decl : declarations)
@@ -138,13 +408,21 @@ CodeGenerator::TypeMembers CodeGenerator::render_members(std::string_view type_n
 		case ifc::DeclSort::Field:
 		{
 			const auto& field = file.fields()[decl.index];
-			const auto type = render_full_typename(field.type);
+			const auto& type = render_full_typename(field.type);
 			const auto name = file.get_string(field.name);
 			const auto access = render_as_neat_access_enum(field.access, "Access::...");
 
-			if (is_member_publicly_accessible(field, ifc::get_kind(scope_decl, file), reflect_private_members))
+			if (is_member_publicly_accessible(field, type_kind, reflect_private_members))
 			{
 				fields += std::format(R"(Field::create<{0}, {1}, &{0}::{2}>("{2}", {3}), )", type_name, type, name, access);
+				if (profiler)
+				{
+					profiler->field_count++;
+				}
+				if (database_type)
+				{
+					database_type->fields.push_back({ .name = std::string{ name }, .type_name = type, .access = convert(field.access).value_or(default_access) });
+				}
 			}
 			break;
 		}
@@ -153,7 +431,7 @@ CodeGenerator::TypeMembers CodeGenerator::render_members(std::string_view type_n
 			const auto& method = file.methods()[decl.index];
 			assert(method.type.sort() == ifc::TypeSort::Method);
 			const auto& method_type = file.method_types()[method.type];
-			const auto return_type = render_full_typename(method_type.target);
+			const auto& return_type = render_full_typename(method_type.target);
 			auto param_types = std::string{ "" };
 			if (!method_type.source.is_null())
 			{
@@ -162,9 +440,22 @@ CodeGenerator::TypeMembers CodeGenerator::render_members(std::string_view type_n
 			const auto name = get_user_type_name(file, method.name);
 			const auto access = render_as_neat_access_enum(method.access);
 
-			if (is_member_publicly_accessible(method, ifc::get_kind(scope_decl, file), reflect_private_members))
+			if (is_member_publicly_accessible(method, type_kind, reflect_private_members))
 			{
 				methods += std::format(R"(Method::create<&{0}::{3}, {0}, {1}{2}>("{3}", {4}), )", type_name, return_type, param_types, name, access);
+				if (profiler)
+				{
+					profiler->method_count++;
+				}
+				if (database_type)
+				{
+					database_type->methods.push_back({
+						.name = std::string{ name },
+						.return_type_name = return_type,
+						.argument_type_names = (method_type.source.is_null() ? std::vector<std::string>{} : render_typenames(method_type.source)),
+						.access = convert(method.access).value_or(default_access)
+					});
+				}
 			}
 			break;
 		}
@@ -173,7 +464,92 @@ CodeGenerator::TypeMembers CodeGenerator::render_members(std::string_view type_n
 	return { fields, methods };
 }
 
-std::string CodeGenerator::render_bases(const ifc::ScopeDeclaration& scope_decl)
+// Enumerators are stored with their value as the initializer, whether it was written out or not
+static int64_t get_enumerator_value(const ifc::File& file, ifc::ExprIndex initializer)
+{
+	if (initializer.sort() != ifc::ExprSort::Literal)
+	{
+		throw ContextualException(std::format("Expected the initializer of an enumerator to be a literal, but it's a {}.", magic_enum::enum_name(initializer.sort())));
+	}
+
+	const auto literal = file.literal_expressions()[initializer].value;
+	switch (literal.sort())
+	{
+	case ifc::LiteralSort::Immediate:
+		return static_cast<int64_t>(literal.index);
+	case ifc::LiteralSort::Integer:
+		return static_cast<int64_t>(file.integer_literals()[literal]);
+	default:
+		throw ContextualException(std::format("Expected the value of an enumerator to be an integer, but it's a {}.", magic_enum::enum_name(literal.sort())));
+	}
+}
+
+void CodeGenerator::render_enum(ifc::DeclIndex index, std::string_view var_name)
+{
+	if (!is_type_exported(index))
+	{
+		return;
+	}
+
+	Profiler::Zone zone{ profiler, Profiler::Phase::Render };
+
+	const auto& enumeration = file.enumerations()[index];
+	const auto type_name = render_namespace(index) + std::string{ file.get_string(enumeration.name) };
+
+	std::optional<DatabaseWriter::Type> database_type;
+	if (database)
+	{
+		database_type.emplace();
+		database_type->name = type_name;
+		database_type->kind = Neat::DatabaseFormat::TypeKind::Enum;
+	}
+
+	std::vector<std::string> names;
+	for (auto& enumerator : file.enumerators().slice(enumeration.initializer))
+	{
+		names.emplace_back(file.get_string(enumerator.name));
+		if (database_type)
+		{
+			database_type->enumerators.push_back({ .name = names.back(), .value = get_enumerator_value(file, enumerator.initializer) });
+		}
+	}
+	std::ranges::sort(names); // `Enum` looks enumerators up by name with a binary search
+
+	// The order by value is only known to the compiler, so that table is filled in when the enum is resolved
+	const auto enum_variable = std::format("{}enum", var_name);
+	if (names.empty())
+	{
+		std::format_to(code, R"(		static constinit Enum {0} = Enum::create<{1}>({{}}, {{}});
+)", enum_variable, type_name);
+	}
+	else
+	{
+		std::string enumerators;
+		for (auto& name : names)
+		{
+			enumerators += std::format(R"(Enumerator::create<{0}::{1}>("{1}"), )", type_name, name);
+		}
+
+		std::format_to(code, R"(		static constinit Enumerator {0}enumerators[] = {{ {1}}};
+		static constinit const Enumerator* {0}by_value[{2}]{{}};
+		static constinit Enum {3} = Enum::create<{4}>({0}enumerators, {0}by_value);
+)", var_name, enumerators, names.size(), enum_variable, type_name);
+	}
+
+	if (profiler)
+	{
+		profiler->type_count++;
+	}
+	type_entries[type_name] = std::format(R"(			Type::create<{0}>("{0}", {1}),
+)", type_name, enum_variable);
+
+	if (database_type)
+	{
+		database->add_type(std::move(*database_type));
+	}
+}
+
+std::string CodeGenerator::render_bases(std::string_view object, const ifc::ScopeDeclaration& scope_decl, DatabaseWriter::Type* database_type)
 {
 	// Otherwise struct
 	const bool is_class = (ifc::get_kind(scope_decl, file) == ifc::TypeBasis::Class);
@@ -185,11 +561,16 @@ std::string CodeGenerator::render_bases(const ifc::ScopeDeclaration& scope_decl)
 		return "";
 	}
 
-	const auto render_base = [this, default_access] (const ifc::BaseType& base_type) -> std::string
+	const auto render_base = [this, object, default_access, is_class, database_type] (const ifc::BaseType& base_type) -> std::string
 	{
 		auto access_string = render_as_neat_access_enum(base_type.access, default_access);
-		auto type_name = render_full_typename(base_type.type);
-		return std::format(R"(BaseClass{{ get_id<{0}>(), {1} }}, )", type_name, access_string);
+		const auto& type_name = render_full_typename(base_type.type);
+		if (database_type)
+		{
+			const auto access = convert(base_type.access).value_or(is_class ? Neat::Access::Private : Neat::Access::Public);
+			database_type->bases.push_back({ .name = type_name, .access = access });
+		}
+		return std::format(R"(BaseClass::create<{0}, {1}>({2}), )", object, type_name, access_string);
 	};
 
 	switch (base_index.sort())
@@ -225,7 +606,31 @@ std::string CodeGenerator::render_bases(const ifc::ScopeDeclaration& scope_decl)
 	}
 }
 
-std::string CodeGenerator::render_full_typename(ifc::TypeIndex type_index)
+const std::string& CodeGenerator::render_full_typename(ifc::TypeIndex type_index)
+{
+	const auto key = cache_key(type_index);
+	if (auto it = full_typename_cache.find(key); it != full_typename_cache.end())
+	{
+		return it->second;
+	}
+
+	auto rendered = render_full_typename_uncached(type_index);
+	return full_typename_cache.emplace(key, std::move(rendered)).first->second;
+}
+
+const std::string& CodeGenerator::render_namespace(ifc::DeclIndex index)
+{
+	const auto key = cache_key(index);
+	if (auto it = namespace_cache.find(key); it != namespace_cache.end())
+	{
+		return it->second;
+	}
+
+	auto rendered = render_namespace_uncached(index);
+	return namespace_cache.emplace(key, std::move(rendered)).first->second;
+}
+
+std::string CodeGenerator::render_full_typename_uncached(ifc::TypeIndex type_index)
 {
 	switch (type_index.sort())
 	{
@@ -234,7 +639,11 @@ std::string CodeGenerator::render_full_typename(ifc::TypeIndex type_index)
 	case ifc::TypeSort::Designated:
 		{
 			const auto& designated_type = file.designated_types()[type_index];
-			return render_namespace(designated_type.decl) + render_refered_declaration(designated_type.decl);
+			if (designated_type.decl.sort() == ifc::DeclSort::Reference)
+			{
+				return resolve_imported(designated_type.decl).full_name;
+			}
+			return render_qualified_name(designated_type.decl);
 		}
 	case ifc::TypeSort::Pointer:
 		return render_full_typename(file.pointer_types()[type_index].pointee) + "*";
@@ -288,6 +697,10 @@ std::string CodeGenerator::render_full_typename(ifc::TypeIndex type_index)
 
 	default:
 		//assert(false && "Not supported yet");
+		if (profiler)
+		{
+			profiler->unsupported_type_count++;
+		}
 		return std::format("<UNSUPPORTED_TYPE {}>", magic_enum::enum_name(type_index.sort()));
 	}
 }
@@ -390,6 +803,21 @@ std::string CodeGenerator::render_full_typename(const ifc::TupleType& types)
 	return rendered;
 }
 
+std::vector<std::string> CodeGenerator::render_typenames(ifc::TypeIndex type_index)
+{
+	if (type_index.sort() != ifc::TypeSort::Tuple)
+	{
+		return { render_full_typename(type_index) };
+	}
+
+	std::vector<std::string> rendered;
+	for (auto& type : file.type_heap().slice(file.tuple_types()[type_index]))
+	{
+		rendered.push_back(render_full_typename(type));
+	}
+	return rendered;
+}
+
 std::string CodeGenerator::render_refered_declaration(const ifc::DeclIndex& decl_index)
 {
 	switch (const auto kind = decl_index.sort())
@@ -434,7 +862,12 @@ std::string CodeGenerator::render_refered_declaration(const ifc::DeclIndex& decl
 	}
 }
 
-std::string CodeGenerator::render_namespace(ifc::DeclIndex index)
+std::string CodeGenerator::render_qualified_name(ifc::DeclIndex index)
+{
+	return render_namespace(index) + render_refered_declaration(index);
+}
+
+std::string CodeGenerator::render_namespace_uncached(ifc::DeclIndex index)
 {
 	ifc::DeclIndex home_scope{};
 
@@ -582,13 +1015,12 @@ bool CodeGenerator::reflects_private_members(ifc::DeclIndex index)
 		case ifc::ExprSort::NamedDecl:
 			{
 				auto& named_decl = file.decl_expressions()[expr_index];
-
-				// TODO OPT: Don't require allocations for these comparisons.
-				auto friend_name = render_namespace(named_decl.resolution) + render_refered_declaration(named_decl.resolution);
-				auto rendered_type = render_full_typename(named_decl.type);
-				return friend_name == "Neat::reflect_private_members"
-					&& rendered_type == "void ()";
+				if (is_reflect_private_members_function(named_decl.resolution, named_decl.type))
+				{
+					return true;
+				}
 			}
+			break;
 		case ifc::ExprSort::TemplateId:
 			// Not supported yet
 
@@ -601,6 +1033,34 @@ bool CodeGenerator::reflects_private_members(ifc::DeclIndex index)
 	return false;
 }
 
+bool CodeGenerator::is_reflect_private_members_function(ifc::DeclIndex decl_index, ifc::TypeIndex type_index)
+{
+	const auto key = cache_key(decl_index);
+	if (reflect_private_members_function)
+	{
+		return key == *reflect_private_members_function;
+	}
+
+	// Cheap check on the unqualified name first, before rendering anything
+	if (decl_index.sort() != ifc::DeclSort::Function)
+	{
+		return false;
+	}
+	const auto function_name = file.functions()[decl_index].name;
+	if (function_name.sort() != ifc::NameSort::Identifier // Friend operators for example
+		|| get_user_type_name(file, function_name) != "reflect_private_members")
+	{
+		return false;
+	}
+
+	const bool matches = render_namespace(decl_index) == "Neat::" && render_full_typename(type_index) == "void ()";
+	if (matches)
+	{
+		reflect_private_members_function = key; // Every friend declaration refers to this same declaration
+	}
+	return matches;
+}
+
 bool CodeGenerator::is_type_exported(ifc::TypeIndex type_index)
 {
 	switch (type_index.sort())
@@ -649,6 +1109,8 @@ bool CodeGenerator::is_type_exported(ifc::DeclIndex index)
 	case ifc::DeclSort::Enumeration:
 		specifiers = file.enumerations()[index].specifiers;
 		break;
+	case ifc::DeclSort::Reference:
+		return resolve_imported(index).is_exported;
 	default:
 		throw ContextualException(std::format("Unexpected declaration while checking if the type decl was exported. type decl sort: {}",
 			magic_enum::enum_name(index.sort())));
@@ -658,6 +1120,25 @@ bool CodeGenerator::is_type_exported(ifc::DeclIndex index)
 	return (magic_enum::enum_underlying(specifiers & ifc::BasicSpecifiers::NonExported) == 0);
 }
 
+const ModuleSet::ImportedDeclaration& CodeGenerator::resolve_imported(ifc::DeclIndex reference)
+{
+	if (module_set == nullptr)
+	{
+		throw ContextualException("Found a declaration imported from another module, which can only be followed when the other modules of the target are loaded too.",
+			"Pass `--resolve-imports=<ifc_dir>` with the directory of the .ifc files of the target, or `RESOLVE_IMPORTS` to `add_reflection_target`.");
+	}
+
+	const auto& decl_reference = file.decl_references()[reference];
+	std::string module_name = file.get_string(decl_reference.unit.owner);
+	if (decl_reference.unit.partition != ifc::TextOffset{})
+	{
+		module_name += ':';
+		module_name += file.get_string(decl_reference.unit.partition);
+	}
+
+	return module_set->resolve(module_name, decl_reference.local_index);
+}
+
 std::optional<Neat::Access> convert(ifc::Access ifc_access)
 {
 	switch (ifc_access)
@@ -686,32 +1167,4 @@ std::string replace_all_copy(std::string str, std::string_view target, std::stri
 		start_pos += replacement.length(); // Handles case where 'to' is a substring of 'from'
 	}
 	return str;
-}
-
-std::string to_snake_case(std::string_view type_name)
-{
-	std::string snake_case;
-	snake_case.reserve(type_name.size() + 10);
-
-	bool previous_uppercase = true;
-	for (auto c : type_name)
-	{
-		if (!previous_uppercase && std::isupper(c))
-		{
-			snake_case.push_back('_');
-		}
-
-		if (std::isalnum(c))
-		{
-			snake_case.push_back(std::tolower(c));
-		}
-		else 
-		{
-			snake_case.push_back('_'); // Fallback
-		}
-
-		previous_uppercase = std::isupper(c);
-	}
-
-	return snake_case;
 }
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "DatabaseWriter.h"
+
+#include "Neat/Database.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <numeric>
+#include <unordered_map>
+
+
+namespace
+{
+	using namespace Neat::DatabaseFormat;
+
+	// Records are zeroed before they are filled in, so the padding doesn't make the output differ between runs
+	template<typename TRecord>
+	TRecord make_record()
+	{
+		TRecord record;
+		std::memset(&record, 0, sizeof(record));
+		return record;
+	}
+
+	class StringTable
+	{
+	public:
+		String add(std::string_view string)
+		{
+			auto [it, is_new] = offsets.try_emplace(std::string{ string }, static_cast<uint32_t>(data.size()));
+			if (is_new)
+			{
+				data += string;
+			}
+			return { .offset = it->second, .size = static_cast<uint32_t>(string.size()) };
+		}
+
+		const std::string& get_data() const { return data; }
+
+	private:
+		std::string data;
+		std::unordered_map<std::string, uint32_t> offsets; // Type names are repeated a lot, so they are only stored once
+	};
+
+	template<typename TRecord>
+	Table append_table(std::string& file, const std::vector<TRecord>& records)
+	{
+		file.resize((file.size() + table_alignment - 1) / table_alignment * table_alignment, '\0');
+
+		const Table table{ .offset = static_cast<uint32_t>(file.size()), .count = static_cast<uint32_t>(records.size()) };
+		file.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(TRecord));
+		return table;
+	}
+}
+
+void DatabaseWriter::add_type(Type type)
+{
+	types.push_back(std::move(type));
+}
+
+void DatabaseWriter::add_types(DatabaseWriter&& other)
+{
+	std::ranges::move(other.types, std::back_inserter(types));
+	other.types.clear();
+}
+
+std::string DatabaseWriter::write(std::string_view module_name) const
+{
+	// Sorted by id, so readers can binary search them
+	std::vector<size_t> sorted_types(types.size());
+	std::iota(sorted_types.begin(), sorted_types.end(), size_t{ 0 });
+	std::ranges::sort(sorted_types, {}, [this](size_t index) { return Neat::get_stable_type_id(types[index].name); });
+
+	StringTable strings;
+	std::vector<TypeRecord> type_records;
+	std::vector<BaseRecord> base_records;
+	std::vector<FieldRecord> field_records;
+	std::vector<MethodRecord> method_records;
+	std::vector<ArgumentRecord> argument_records;
+	std::vector<EnumeratorRecord> enumerator_records;
+
+	for (size_t index : sorted_types)
+	{
+		const Type& type = types[index];
+
+		auto& type_record = type_records.emplace_back(make_record<TypeRecord>());
+		type_record.id = Neat::get_stable_type_id(type.name);
+		type_record.name = strings.add(type.name);
+		type_record.kind = type.kind;
+		type_record.bases = { .first = static_cast<uint32_t>(base_records.size()), .count = static_cast<uint32_t>(type.bases.size()) };
+		type_record.fields = { .first = static_cast<uint32_t>(field_records.size()), .count = static_cast<uint32_t>(type.fields.size()) };
+		type_record.methods = { .first = static_cast<uint32_t>(method_records.size()), .count = static_cast<uint32_t>(type.methods.size()) };
+		type_record.enumerators = { .first = static_cast<uint32_t>(enumerator_records.size()), .count = static_cast<uint32_t>(type.enumerators.size()) };
+
+		for (auto& base : type.bases)
+		{
+			auto& record = base_records.emplace_back(make_record<BaseRecord>());
+			record.id = Neat::get_stable_type_id(base.name);
+			record.name = strings.add(base.name);
+			record.access = base.access;
+		}
+
+		for (auto& field : type.fields)
+		{
+			auto& record = field_records.emplace_back(make_record<FieldRecord>());
+			record.type = Neat::get_stable_type_id(field.type_name);
+			record.name = strings.add(field.name);
+			record.type_name = strings.add(field.type_name);
+			record.access = field.access;
+		}
+
+		for (auto& method : type.methods)
+		{
+			auto& record = method_records.emplace_back(make_record<MethodRecord>());
+			record.return_type = Neat::get_stable_type_id(method.return_type_name);
+			record.name = strings.add(method.name);
+			record.return_type_name = strings.add(method.return_type_name);
+			record.arguments = { .first = static_cast<uint32_t>(argument_records.size()), .count = static_cast<uint32_t>(method.argument_type_names.size()) };
+			record.access = method.access;
+
+			for (auto& argument_type_name : method.argument_type_names)
+			{
+				auto& argument = argument_records.emplace_back(make_record<ArgumentRecord>());
+				argument.type = Neat::get_stable_type_id(argument_type_name);
+				argument.type_name = strings.add(argument_type_name);
+			}
+		}
+
+		for (auto& enumerator : type.enumerators)
+		{
+			auto& record = enumerator_records.emplace_back(make_record<EnumeratorRecord>());
+			record.value = enumerator.value;
+			record.name = strings.add(enumerator.name);
+		}
+	}
+
+	auto header = make_record<Header>();
+	header.magic = magic;
+	header.version = version;
+	header.module_name = strings.add(module_name);
+
+	std::string file(sizeof(Header), '\0'); // The header is filled in last, once the tables are placed
+	header.types = append_table(file, type_records);
+	header.bases = append_table(file, base_records);
+	header.fields = append_table(file, field_records);
+	header.methods = append_table(file, method_records);
+	header.arguments = append_table(file, argument_records);
+	header.enumerators = append_table(file, enumerator_records);
+
+	const std::string& string_data = strings.get_data();
+	header.strings = append_table(file, std::vector<char>{ string_data.begin(), string_data.end() });
+	header.file_size = static_cast<uint32_t>(file.size());
+
+	std::memcpy(file.data(), &header, sizeof(header));
+	return file;
+}
@@ -1,114 +1,442 @@
 #include "CodeGenerator.h"
+#include "DatabaseWriter.h"
+#include "Manifest.h"
+#include "ModuleSet.h"
+#include "OutputFile.h"
+#include "Profiler.h"
 
 #include <ContextualException.h>
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
+#include <string_view>
 #include <filesystem>
 #include <span>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <optional>
 
 #include "docopt.h"
 #include "mio/mmap.hpp"
 #include "ifc/File.h"
-#include "ifc/Environment.h"
 //#include "ifc/MSVCEnvironment.h"
 
 
 constexpr auto USAGE = R"(Usage: 
-    NeatReflectionCodeGen.exe <in_ifc_file> <out_cpp_file>
-    NeatReflectionCodeGen.exe scan <in_dir> <out_dir>)";
-
-//class MioBlobHolder : public ifc::Environment::BlobHolder
-//{
-//public:
-//    MioBlobHolder(const std::filesystem::path& path)
-//        : memory_mapped_file(path)
-//    {}
-//
-//    static ifc::Environment::BlobHolderPtr create_unique(const std::filesystem::path& path)
-//    {
-//        return std::make_unique<MioBlobHolder>(path);
-//    }
-//
-//    ifc::File::BlobView view() const override
-//    {
-//        return std::as_bytes(std::span{ memory_mapped_file.data(), memory_mapped_file.size() });
-//    }
-//
-//private:
-//    mio::mmap_source memory_mapped_file;
-//};
-
-bool convert_ifc_file(const std::string& ifc_filename, const std::string& cpp_filename) try
+    NeatReflectionCodeGen.exe <in_ifc_file> <out_cpp_file> [--jobs=<count>] [--force] [--resolve-imports=<ifc_dir>] [--database] [--stats] [--trace=<json_file>]
+    NeatReflectionCodeGen.exe scan <in_dir> <out_dir> [--jobs=<count>] [--force] [--resolve-imports=<ifc_dir>] [--database] [--stats] [--trace=<json_file>]
+    NeatReflectionCodeGen.exe serve [--jobs=<count>] [--force]
+
+Options:
+    -j <count>, --jobs=<count>  Number of threads, 0 uses all hardware threads. Files are converted in parallel and
+                                threads left over render the types of a file in parallel. Those are still written
+                                as they're rendered, only a few per thread are held in memory [default: 1]
+    --force                     Convert every file, even when it didn't change since it was last converted
+    --resolve-imports=<ifc_dir> Load all .ifc files of <ifc_dir> together, so members of types imported from another
+                                module of the same target can be reflected too. Usually the directory with the .ifc
+                                files of the target, which in scan mode is <in_dir>
+    --database                  Also write a reflection database next to every .cpp file (with the extension .refldb),
+                                which tools can memory map and read with `Neat::Database`
+    --stats                     Print how long loading, scanning, rendering and writing took for every file, and how
+                                many types, fields, methods and unsupported types it contains
+    --trace=<json_file>         Write the timings of every file as a Chrome trace, see chrome://tracing)";
+
+// Diagnostics are written to `log` instead of std::cout, so files converted in parallel don't interleave their output.
+// The file is skipped when `manifest` shows it didn't change since the last conversion, unless `force` is set.
+// Imported declarations are resolved through `module_set`, when given.
+// Where the time goes is recorded in `profiler`, when given. A reflection database is written as well with `write_database`.
+// The types are rendered on `render_job_count` threads, the output doesn't depend on it.
+bool convert_ifc_file(const std::string& ifc_filename, const std::string& cpp_filename, std::ostream& log, Manifest& manifest, bool force, 
+    ModuleSet* module_set = nullptr, Profiler* profiler = nullptr, bool write_database = false, size_t render_job_count = 1) try
 {
     ContextArea filename_context{ std::format("While loading ifc file: '{0}'.\nAnd preparing to output to: '{1}'", ifc_filename, cpp_filename) };
 
     if (!std::filesystem::exists(ifc_filename))
     {
-        std::cout << "ERROR: in_ifc_file: '" << ifc_filename << "' does not exist.";
+        log << "ERROR: in_ifc_file: '" << ifc_filename << "' does not exist.";
         return false;
     }
     if (!ifc_filename.ends_with(".ifc"))
     {
-        std::cout << "ERROR: in_ifc_file: '" << ifc_filename << "' is not a .ifc file. It's extension is: " << std::filesystem::path{ ifc_filename }.extension() << '\n';
+        log << "ERROR: in_ifc_file: '" << ifc_filename << "' is not a .ifc file. It's extension is: " << std::filesystem::path{ ifc_filename }.extension() << '\n';
+        return false;
+    }
+
+    if (!cpp_filename.ends_with(".cpp"))
+    {
+        log << "ERROR: out_cpp_file: '" << cpp_filename << "' is not a .cpp file. It's extension is: " << std::filesystem::path{ cpp_filename }.extension() << '\n';
         return false;
     }
 
+    std::optional<Profiler::Zone> load_zone{ std::in_place, profiler, Profiler::Phase::Load };
     mio::mmap_source mmapped_file{ ifc_filename };
     auto file_bytes = std::as_bytes(std::span{ mmapped_file.data(), mmapped_file.size() });
 
-    //ifc::Environment environment{ ifc::read_msvc_config(ifc_filename + ".d.json"), &MioBlobHolder::create_unique };
-    ifc::File ifc_file{ file_bytes };
+    // Names of imported types end up in the output too, so then it also depends on the other modules
+    const uint64_t file_hashes[] = { hash_bytes(file_bytes), module_set ? module_set->get_input_hash() : 0 };
+    const auto input_hash = (module_set ? hash_bytes(std::as_bytes(std::span{ file_hashes })) : file_hashes[0]);
+    const auto database_filename = std::filesystem::path{ cpp_filename }.replace_extension("refldb");
+    if (!force && manifest.is_up_to_date(cpp_filename, input_hash) && (!write_database || std::filesystem::exists(database_filename)))
+    {
+        log << "Skipping '" << ifc_filename << "', it didn't change since it was last converted.\n";
+        return true;
+    }
+    manifest.remove(cpp_filename); // In case the conversion fails
+
+    ifc::File ifc_file{ file_bytes }; // Not shared with `module_set` or the render threads, so files are never read from multiple threads
+    load_zone.reset();
 
-    std::ofstream file_stream{ cpp_filename, std::ofstream::out | std::ofstream::trunc };
-    if (!file_stream.good())
+    // Leaves the output untouched when it's the same, so it's timestamp doesn't change and it won't be recompiled
+    OutputFile output_file{ cpp_filename, profiler };
+    std::ostream output_stream{ &output_file };
+
+    std::optional<DatabaseWriter> database;
+    if (write_database)
     {
-        std::cout << "ERROR: Could not open output file '" << cpp_filename << "' for writing. Reason: " << strerror(errno) << '\n';
-        return false;
+        database.emplace();
     }
-    if (!cpp_filename.ends_with(".cpp"))
+
+    CodeGenerator code_generator{ ifc_file, module_set, profiler, database ? &*database : nullptr };
+    code_generator.write_cpp_file(output_stream, render_job_count, file_bytes);
+
+    if (!output_stream.good() || !output_file.commit())
     {
-        std::cout << "ERROR: out_cpp_file: '" << cpp_filename << "' is not a .cpp file. It's extension is: " << std::filesystem::path{ cpp_filename }.extension() << '\n';
+        log << "ERROR: Could not write output file '" << cpp_filename << "'. Reason: " << strerror(errno) << '\n';
         return false;
     }
 
-    CodeGenerator code_generator{ ifc_file };
-    code_generator.write_cpp_file(file_stream);
+    if (database)
+    {
+        Profiler::Zone write_zone{ profiler, Profiler::Phase::Write };
+        if (!write_file_if_changed(database_filename, database->write(get_module_name(ifc_file))))
+        {
+            log << "ERROR: Could not write database file '" << database_filename.string() << "'. Reason: " << strerror(errno) << '\n';
+            return false;
+        }
+    }
 
+    manifest.set(cpp_filename, input_hash);
     return true;
 }
+catch (const std::exception& exception)
+{
+    log << exception.what() << '\n';
+    return false;
+}
 catch (...)
 {
     return false;
 }
 
+std::filesystem::path get_scan_manifest_path(const std::filesystem::path& output_dir)
+{
+    return output_dir / "NeatReflectionCodeGen.manifest";
+}
+
+std::filesystem::path get_file_manifest_path(const std::string& cpp_filename)
+{
+    return cpp_filename + ".manifest";
+}
+
+std::vector<std::filesystem::path> find_ifc_files(const std::filesystem::path& dir)
+{
+    std::vector<std::filesystem::path> ifc_files;
+    for (auto entry : std::filesystem::directory_iterator{ dir })
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".ifc")
+        {
+            ifc_files.push_back(entry.path());
+        }
+    }
+    return ifc_files;
+}
+
+// Loads all .ifc files of `ifc_dir` together, so imports between them can be resolved. Returns nullptr when that fails.
+std::unique_ptr<ModuleSet> load_module_set(const std::filesystem::path& ifc_dir, std::ostream& log) try
+{
+    return std::make_unique<ModuleSet>(find_ifc_files(ifc_dir));
+}
+catch (const std::exception& exception)
+{
+    log << exception.what() << '\n' << "ERROR: Could not load the modules of '" << ifc_dir << "'\n";
+    return nullptr;
+}
+
+// Returns the amount of files which failed to convert. When `profiles` is given, one is added for every file.
+// Imports are resolved through `module_set` when given, it's shared by all files so every imported declaration is only resolved once.
+size_t scan_directory(const std::filesystem::path& target_dir, const std::filesystem::path& output_dir, size_t job_count, bool force, Manifest& manifest, 
+    ModuleSet* module_set = nullptr, std::vector<Profiler>* profiles = nullptr, bool write_database = false)
+{
+    const std::vector<std::filesystem::path> ifc_files = find_ifc_files(target_dir);
+
+    // Added up front, so the workers don't have to synchronise
+    const size_t first_profile = (profiles ? profiles->size() : 0);
+    if (profiles)
+    {
+        for (auto& ifc_file : ifc_files)
+        {
+            profiles->emplace_back(ifc_file.string());
+        }
+    }
+
+    // Threads which don't get a file of their own help rendering, so a single huge module doesn't leave them idle
+    const size_t render_job_count = std::max(size_t{ 1 }, job_count / std::max(size_t{ 1 }, std::min(job_count, ifc_files.size())));
+
+    std::mutex output_mutex;
+    std::atomic<size_t> next_file_index = 0;
+    std::atomic<size_t> failed_count = 0;
+
+    const auto convert_files = [&]()
+    {
+        for (size_t i = next_file_index++; i < ifc_files.size(); i = next_file_index++)
+        {
+            const auto& ifc_file = ifc_files[i];
+            auto output_filename = std::filesystem::absolute(output_dir / ifc_file.filename().replace_extension("cpp"));
+
+            std::ostringstream log;
+            log << "Converting '" << std::filesystem::absolute(ifc_file) << "' to '" << output_filename << "'\n";
+
+            Profiler* profiler = (profiles ? &(*profiles)[first_profile + i] : nullptr);
+            if (!convert_ifc_file(ifc_file.string(), output_filename.string(), log, manifest, force, module_set, profiler, write_database, render_job_count))
+            {
+                log << "ERROR: Failed to convert '" << ifc_file << "'\n";
+                failed_count++;
+            }
+
+            std::scoped_lock lock{ output_mutex };
+            std::cout << log.str();
+        }
+    };
+
+    job_count = std::min(job_count, ifc_files.size());
+    if (job_count <= 1)
+    {
+        convert_files();
+    }
+    else
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(job_count);
+        for (size_t i = 0; i < job_count; i++)
+        {
+            workers.emplace_back(convert_files);
+        }
+    } // jthreads join here
+
+    if (!manifest.save())
+    {
+        std::cout << "WARNING: Could not save the manifest, so every file will be converted again next time.\n";
+    }
+
+    if (failed_count > 0)
+    {
+        std::cout << "ERROR: " << failed_count << " out of " << ifc_files.size() << " files failed to convert\n";
+    }
+    return failed_count;
+}
+
+// Changes whenever a .ifc file of `ifc_dir` is added, removed or written, without reading any of them
+uint64_t get_ifc_dir_snapshot(const std::filesystem::path& ifc_dir)
+{
+    std::vector<uint64_t> hashes;
+    for (const auto& path : find_ifc_files(ifc_dir))
+    {
+        const auto filename = path.filename().string();
+        hashes.push_back(hash_bytes(std::as_bytes(std::span{ filename })));
+        hashes.push_back(std::filesystem::file_size(path));
+        hashes.push_back(static_cast<uint64_t>(std::filesystem::last_write_time(path).time_since_epoch().count()));
+    }
+    std::sort(hashes.begin(), hashes.end()); // Directory order isn't specified
+    return hash_bytes(std::as_bytes(std::span{ hashes }));
+}
+
+// Keeps running and converting files, so build systems only pay once for starting the tool and loading manifests.
+// Reads one request per line from stdin, with tab separated arguments:
+//     convert <in_ifc_file> <out_cpp_file> [--resolve-imports=<ifc_dir>] [--database]
+//     scan <in_dir> <out_dir> [--resolve-imports=<ifc_dir>] [--database]
+//     quit
+// The options mean the same as on the command line. The modules loaded for `--resolve-imports` stay loaded between
+// requests together with the imports resolved from them, until a .ifc file of their directory changes.
+// Diagnostics are written to stdout, and every response ends with a line of either `@done ok` or `@done error`.
+int serve(size_t job_count, bool force)
+{
+    std::map<std::filesystem::path, std::unique_ptr<Manifest>> manifests; // Stay loaded between requests
+    const auto get_manifest = [&manifests](const std::filesystem::path& path) -> Manifest&
+    {
+        auto& manifest = manifests[path];
+        if (!manifest)
+        {
+            manifest = std::make_unique<Manifest>(path);
+        }
+        return *manifest;
+    };
+
+    struct LoadedModuleSet
+    {
+        uint64_t snapshot = 0;
+        std::unique_ptr<ModuleSet> module_set;
+    };
+    std::map<std::filesystem::path, LoadedModuleSet> module_sets; // By ifc directory
+    const auto get_module_set = [&module_sets](const std::filesystem::path& ifc_dir) -> ModuleSet*
+    {
+        try
+        {
+            auto& loaded = module_sets[std::filesystem::absolute(ifc_dir)];
+            const uint64_t snapshot = get_ifc_dir_snapshot(ifc_dir);
+            if (!loaded.module_set || loaded.snapshot != snapshot)
+            {
+                loaded.module_set.reset(); // Before loading again, so the old files aren't held twice
+                loaded.module_set = std::make_unique<ModuleSet>(find_ifc_files(ifc_dir), ModuleSet::FileAccess::Read);
+                loaded.snapshot = snapshot;
+            }
+            return loaded.module_set.get();
+        }
+        catch (const std::exception& exception)
+        {
+            std::cout << exception.what() << '\n' << "ERROR: Could not load the modules of '" << ifc_dir << "'\n";
+            module_sets.erase(std::filesystem::absolute(ifc_dir));
+            return nullptr;
+        }
+    };
+
+    std::string line;
+    while (std::getline(std::cin, line))
+    {
+        if (line.ends_with('\r'))
+        {
+            line.pop_back();
+        }
+
+        std::vector<std::string> request;
+        for (size_t start = 0, end = 0; end != std::string::npos; start = end + 1)
+        {
+            end = line.find('\t', start);
+            request.push_back(line.substr(start, end - start));
+        }
+
+        // Options follow the positional arguments of `convert` and `scan`
+        bool valid_options = (request.size() >= 3);
+        bool write_database = false;
+        std::optional<std::filesystem::path> ifc_dir;
+        for (size_t i = 3; i < request.size(); i++)
+        {
+            constexpr std::string_view resolve_imports_option = "--resolve-imports=";
+            if (request[i] == "--database")
+            {
+                write_database = true;
+            }
+            else if (request[i].starts_with(resolve_imports_option) && request[i].size() > resolve_imports_option.size())
+            {
+                ifc_dir = request[i].substr(resolve_imports_option.size());
+            }
+            else
+            {
+                valid_options = false;
+            }
+        }
+
+        bool succeeded = false;
+        if (request[0] == "quit" && request.size() == 1)
+        {
+            break;
+        }
+        else if ((request[0] == "convert" || request[0] == "scan") && valid_options)
+        {
+            ModuleSet* module_set = (ifc_dir ? get_module_set(*ifc_dir) : nullptr);
+            if (!ifc_dir || module_set)
+            {
+                if (request[0] == "convert")
+                {
+                    auto& manifest = get_manifest(get_file_manifest_path(request[2]));
+                    succeeded = convert_ifc_file(request[1], request[2], std::cout, manifest, force, module_set, nullptr, write_database, job_count);
+                    manifest.save();
+                }
+                else
+                {
+                    auto& manifest = get_manifest(get_scan_manifest_path(request[2]));
+                    succeeded = (scan_directory(request[1], request[2], job_count, force, manifest, module_set, nullptr, write_database) == 0);
+                }
+            }
+        }
+        else
+        {
+            std::cout << "ERROR: Invalid request: '" << line << "'\n";
+        }
+
+        std::cout << "@done " << (succeeded ? "ok" : "error") << std::endl; // Flush, the client is waiting for it
+    }
+
+    return 0;
+}
+
+// Returns false when the trace couldn't be written
+bool report_profiles(const docopt::Options& parsed, std::span<const Profiler> profiles)
+{
+    if (parsed.at("--stats").asBool())
+    {
+        print_statistics(std::cout, profiles);
+    }
+
+    if (const auto& trace_file = parsed.at("--trace"); trace_file && !write_chrome_trace(trace_file.asString(), profiles))
+    {
+        std::cout << "ERROR: Could not write the trace to '" << trace_file.asString() << "'\n";
+        return false;
+    }
+    return true;
+}
+
 int main(int argc, char const *argv[])
 {
     std::cout << "Running NeatReflectionCodeGen!\n";
 
     const std::vector<std::string> arguments{ argv + 1, argv + argc };
     docopt::Options parsed = docopt::docopt(USAGE, arguments, true, "0.1");
+    const bool force = parsed["--force"].asBool();
+    const bool write_database = parsed["--database"].asBool();
 
-    if (parsed["scan"].asBool())
+    const long jobs = parsed["--jobs"].asLong();
+    if (jobs < 0)
+    {
+        std::cout << "ERROR: --jobs needs to be 0 or more, but " << jobs << " was given.\n";
+        return 1;
+    }
+    const size_t job_count = (jobs == 0 ? std::max(1u, std::thread::hardware_concurrency()) : static_cast<size_t>(jobs));
+
+    const bool profile = (parsed["--stats"].asBool() || parsed["--trace"]);
+    std::vector<Profiler> profiles;
+
+    std::unique_ptr<ModuleSet> module_set;
+    if (const auto& ifc_dir = parsed["--resolve-imports"])
+    {
+        module_set = load_module_set(ifc_dir.asString(), std::cout);
+        if (!module_set)
+        {
+            return 1;
+        }
+    }
+
+    if (parsed["serve"].asBool())
+    {
+        return serve(job_count, force);
+    }
+    else if (parsed["scan"].asBool())
     {
         const std::filesystem::path target_dir = parsed["<in_dir>"].asString();
         const std::filesystem::path output_dir = parsed["<out_dir>"].asString();
 
-        for (auto entry : std::filesystem::directory_iterator{ target_dir })
+        Manifest manifest{ get_scan_manifest_path(output_dir) };
+        const size_t failed_count = scan_directory(target_dir, output_dir, job_count, force, manifest, module_set.get(), 
+            profile ? &profiles : nullptr, write_database);
+        if (!report_profiles(parsed, profiles) || failed_count > 0)
         {
-            if (entry.is_regular_file() && entry.path().extension() == ".ifc")
-            {
-                auto output_filename = std::filesystem::absolute(output_dir / entry.path().filename().replace_extension("cpp"));
-                
-                std::cout << "Converting '" << std::filesystem::absolute(entry) << "' to '" << output_filename << "'\n";
-
-                if (!convert_ifc_file( entry.path().string(), output_filename.string()))
-                {
-                    std::cout << "ERROR: Failed to convert '" << entry << "'\n";
-                    return 1;
-                }
-            }
+            return 1;
         }
     }
     else 
@@ -116,11 +444,22 @@ int main(int argc, char const *argv[])
         const std::string ifc = parsed["<in_ifc_file>"].asString();
         const std::string cpp = parsed["<out_cpp_file>"].asString();
 
-        if (!convert_ifc_file(ifc, cpp))
+        Manifest manifest{ get_file_manifest_path(cpp) };
+        if (profile)
+        {
+            profiles.emplace_back(ifc);
+        }
+        const bool converted = convert_ifc_file(ifc, cpp, std::cout, manifest, force, module_set.get(), profile ? &profiles.back() : nullptr, write_database, job_count);
+        if (!manifest.save())
+        {
+            std::cout << "WARNING: Could not save the manifest, so the file will be converted again next time.\n";
+        }
+
+        if (!report_profiles(parsed, profiles) || !converted)
         {
             return 1;
         }
     }
 
     return 0;
-}
\ No newline at end of file
+}
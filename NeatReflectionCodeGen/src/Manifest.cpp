@@ -0,0 +1,96 @@
+#include "Manifest.h"
+
+#include "CodeGenerator.h"
+#include "OutputFile.h"
+
+#include <format>
+#include <fstream>
+#include <sstream>
+
+
+namespace
+{
+	constexpr std::string_view MANIFEST_HEADER = "NeatReflectionCodeGen manifest";
+}
+
+Manifest::Manifest(std::filesystem::path path)
+	: path(std::move(path))
+{
+	std::ifstream file{ this->path };
+	if (!file.good())
+	{
+		return;
+	}
+
+	std::string header;
+	std::getline(file, header);
+	if (header != std::format("{} {}", MANIFEST_HEADER, CODE_GENERATOR_VERSION))
+	{
+		return; // Outputs of another version would be different, so everything needs to be generated again
+	}
+
+	// Every line is: <input hash as hex> <output file>
+	std::string line;
+	while (std::getline(file, line))
+	{
+		const auto separator = line.find(' ');
+		if (separator == std::string::npos)
+		{
+			continue;
+		}
+
+		try {
+			input_hash_by_output_file[line.substr(separator + 1)] = std::stoull(line.substr(0, separator), nullptr, 16);
+		}
+		catch (const std::exception&) {
+			// Ignore a corrupt line, it's output will just be generated again
+		}
+	}
+}
+
+void Manifest::set(const std::filesystem::path& output_file, uint64_t input_hash)
+{
+	std::scoped_lock lock{ mutex };
+	input_hash_by_output_file[output_file.generic_string()] = input_hash;
+}
+
+void Manifest::remove(const std::filesystem::path& output_file)
+{
+	std::scoped_lock lock{ mutex };
+	input_hash_by_output_file.erase(output_file.generic_string());
+}
+
+bool Manifest::save() const
+{
+	std::scoped_lock lock{ mutex };
+
+	std::ostringstream content;
+	content << MANIFEST_HEADER << ' ' << CODE_GENERATOR_VERSION << '\n';
+	for (auto& [output_file, input_hash] : input_hash_by_output_file)
+	{
+		content << std::format("{:016x} {}\n", input_hash, output_file);
+	}
+
+	return write_file_if_changed(path, content.str());
+}
+
+bool Manifest::is_up_to_date(const std::filesystem::path& output_file, uint64_t input_hash) const
+{
+	std::scoped_lock lock{ mutex };
+
+	auto it = input_hash_by_output_file.find(output_file.generic_string());
+	return it != input_hash_by_output_file.end()
+		&& it->second == input_hash
+		&& std::filesystem::exists(output_file); // Someone might have deleted it
+}
+
+uint64_t hash_bytes(std::span<const std::byte> bytes)
+{
+	uint64_t hash = 0xcbf29ce484222325;
+	for (auto byte : bytes)
+	{
+		hash ^= static_cast<uint64_t>(byte);
+		hash *= 0x100000001b3;
+	}
+	return hash;
+}
@@ -0,0 +1,140 @@
+#include "ModuleSet.h"
+
+#include "CodeGenerator.h"
+#include "ContextualException.h"
+#include "Manifest.h"
+
+#include <format>
+#include <fstream>
+
+#include "mio/mmap.hpp"
+#include "ifc/File.h"
+#include "ifc/Declaration.h"
+
+
+namespace
+{
+	class MioBlobHolder : public ifc::Environment::BlobHolder
+	{
+	public:
+		MioBlobHolder(const std::filesystem::path& path)
+			: memory_mapped_file(path.string())
+		{}
+
+		static ifc::Environment::BlobHolderPtr create_unique(const std::filesystem::path& path)
+		{
+			return std::make_unique<MioBlobHolder>(path);
+		}
+
+		ifc::File::BlobView view() const override
+		{
+			return std::as_bytes(std::span{ memory_mapped_file.data(), memory_mapped_file.size() });
+		}
+
+	private:
+		mio::mmap_source memory_mapped_file;
+	};
+
+	class MemoryBlobHolder : public ifc::Environment::BlobHolder
+	{
+	public:
+		MemoryBlobHolder(const std::filesystem::path& path)
+		{
+			std::ifstream file{ path, std::ios::binary };
+			if (!file)
+			{
+				throw ContextualException(std::format("Could not open '{}'", path.string()));
+			}
+			bytes.resize(std::filesystem::file_size(path));
+			file.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+			if (!file)
+			{
+				throw ContextualException(std::format("Could not read '{}'", path.string()));
+			}
+		}
+
+		static ifc::Environment::BlobHolderPtr create_unique(const std::filesystem::path& path)
+		{
+			return std::make_unique<MemoryBlobHolder>(path);
+		}
+
+		ifc::File::BlobView view() const override
+		{
+			return std::span{ bytes };
+		}
+
+	private:
+		std::vector<std::byte> bytes;
+	};
+}
+
+ModuleSet::ModuleSet(std::span<const std::filesystem::path> ifc_files, FileAccess file_access)
+{
+	std::vector<uint64_t> file_hashes;
+	file_hashes.reserve(ifc_files.size());
+
+	for (const auto& path : ifc_files)
+	{
+		ContextArea context{ std::format("While loading '{}' as part of the module set", path.string()) };
+
+		auto module = std::make_unique<Module>();
+		module->path = path;
+		module->blob = (file_access == FileAccess::Map ? MioBlobHolder::create_unique(path) : MemoryBlobHolder::create_unique(path));
+		module->file = std::make_unique<ifc::File>(module->blob->view());
+
+		file_hashes.push_back(hash_bytes(module->blob->view()));
+		module_by_name[get_module_name(*module->file)] = module.get();
+		modules.push_back(std::move(module));
+	}
+
+	input_hash = hash_bytes(std::as_bytes(std::span{ file_hashes }));
+}
+
+ModuleSet::~ModuleSet() = default;
+
+uint64_t ModuleSet::get_input_hash() const
+{
+	return input_hash;
+}
+
+const ModuleSet::ImportedDeclaration& ModuleSet::resolve(std::string_view module_name, ifc::DeclIndex index)
+{
+	std::scoped_lock lock{ mutex };
+
+	auto module_it = module_by_name.find(std::string{ module_name });
+	if (module_it == module_by_name.end())
+	{
+		throw ContextualException(std::format("A declaration is imported from module '{}', which isn't part of the target.", module_name),
+			"Only modules of the same target can be followed, other modules need to be reflected by their own target.");
+	}
+	Module& module = *module_it->second;
+
+	auto& resolved = resolved_declarations[&module];
+	if (auto it = resolved.find(cache_key(index)); it != resolved.end())
+	{
+		return it->second;
+	}
+
+	if (!module.renderer)
+	{
+		module.renderer = std::make_unique<CodeGenerator>(*module.file, this);
+	}
+
+	ContextArea context{ std::format("While resolving a declaration imported from module '{}'", module_name) };
+	ImportedDeclaration declaration;
+	if (index.sort() == ifc::DeclSort::Reference)
+	{
+		declaration = module.renderer->resolve_imported(index); // Reexported from yet another module
+	}
+	else
+	{
+		declaration.full_name = module.renderer->render_qualified_name(index);
+		declaration.is_exported = module.renderer->is_type_exported(index);
+	}
+	return resolved.emplace(cache_key(index), std::move(declaration)).first->second;
+}
+
+std::string get_module_name(const ifc::File& file)
+{
+	return file.get_string(ifc::TextOffset{ file.header().unit.index });
+}
@@ -0,0 +1,151 @@
+#include "OutputFile.h"
+
+#include "Profiler.h"
+
+#include <algorithm>
+#include <ostream>
+#include <system_error>
+
+
+OutputFile::OutputFile(std::filesystem::path path, Profiler* profiler)
+	: path(std::move(path))
+	, temporary_path(this->path.string() + ".tmp")
+	, existing_file(this->path, std::ifstream::binary)
+	, profiler(profiler)
+	, buffer(buffer_size)
+	, existing_buffer(buffer_size)
+{
+	if (!existing_file.is_open())
+	{
+		start_writing(); // Nothing to compare against
+	}
+
+	setp(buffer.data(), buffer.data() + buffer.size());
+}
+
+OutputFile::~OutputFile()
+{
+	if (temporary_file.is_open()) // Not committed
+	{
+		temporary_file.close();
+		std::error_code error;
+		std::filesystem::remove(temporary_path, error);
+	}
+}
+
+bool OutputFile::commit()
+{
+	Profiler::Zone zone{ profiler, Profiler::Phase::Write };
+
+	if (!flush_buffer())
+	{
+		return false;
+	}
+
+	if (existing_file.is_open())
+	{
+		// Everything matched, unless the existing file is longer
+		if (existing_file.peek() == std::ifstream::traits_type::eof())
+		{
+			existing_file.close();
+			return true;
+		}
+		if (!start_writing())
+		{
+			return false;
+		}
+	}
+
+	temporary_file.close();
+	if (!temporary_file)
+	{
+		return false;
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporary_path, path, error);
+	return !error;
+}
+
+OutputFile::int_type OutputFile::overflow(int_type character)
+{
+	if (!flush_buffer())
+	{
+		return traits_type::eof();
+	}
+
+	if (!traits_type::eq_int_type(character, traits_type::eof()))
+	{
+		*pptr() = traits_type::to_char_type(character);
+		pbump(1);
+	}
+	return traits_type::not_eof(character);
+}
+
+int OutputFile::sync()
+{
+	return flush_buffer() ? 0 : -1;
+}
+
+bool OutputFile::flush_buffer()
+{
+	Profiler::Zone zone{ profiler, Profiler::Phase::Write };
+
+	const auto size = static_cast<std::streamsize>(pptr() - pbase());
+	setp(buffer.data(), buffer.data() + buffer.size());
+
+	if (failed)
+	{
+		return false;
+	}
+
+	if (existing_file.is_open())
+	{
+		existing_file.read(existing_buffer.data(), size);
+		if (existing_file.gcount() == size && std::equal(buffer.data(), buffer.data() + size, existing_buffer.data()))
+		{
+			matched_size += size;
+			return true;
+		}
+
+		if (!start_writing())
+		{
+			return false;
+		}
+	}
+
+	temporary_file.write(buffer.data(), size);
+	failed = !temporary_file;
+	return !failed;
+}
+
+bool OutputFile::start_writing()
+{
+	temporary_file.open(temporary_path, std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+
+	// Copy over the part which matched so far, it isn't buffered anymore
+	if (existing_file.is_open())
+	{
+		existing_file.clear();
+		existing_file.seekg(0);
+		for (std::streamsize copied = 0; copied < matched_size && existing_file; )
+		{
+			const auto chunk_size = std::min<std::streamsize>(matched_size - copied, buffer_size);
+			existing_file.read(existing_buffer.data(), chunk_size);
+			temporary_file.write(existing_buffer.data(), existing_file.gcount());
+			copied += existing_file.gcount();
+		}
+		existing_file.close();
+	}
+
+	failed = !temporary_file;
+	return !failed;
+}
+
+bool write_file_if_changed(const std::filesystem::path& file, std::string_view content)
+{
+	OutputFile output_file{ file };
+	std::ostream stream{ &output_file };
+	stream.write(content.data(), content.size());
+	return stream.good() && output_file.commit();
+}
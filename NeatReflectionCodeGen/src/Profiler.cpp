@@ -0,0 +1,207 @@
+#include "Profiler.h"
+
+#include "OutputFile.h"
+
+#include <algorithm>
+#include <cassert>
+#include <format>
+#include <iterator>
+#include <numeric>
+#include <unordered_map>
+
+
+namespace
+{
+	using Milliseconds = std::chrono::duration<double, std::milli>;
+	using Microseconds = std::chrono::duration<double, std::micro>;
+
+	Profiler::Clock::duration get_total_time(const Profiler& profile)
+	{
+		return std::accumulate(profile.phase_times.begin(), profile.phase_times.end(), Profiler::Clock::duration{});
+	}
+
+	std::string escape_json(std::string_view text)
+	{
+		std::string escaped;
+		escaped.reserve(text.size());
+		for (char character : text)
+		{
+			switch (character)
+			{
+			case '"': escaped += "\\\""; break;
+			case '\\': escaped += "\\\\"; break;
+			case '\n': escaped += "\\n"; break;
+			case '\t': escaped += "\\t"; break;
+			default:
+				if (static_cast<unsigned char>(character) < 0x20)
+				{
+					std::format_to(std::back_inserter(escaped), "\\u{:04x}", character);
+				}
+				else
+				{
+					escaped += character;
+				}
+			}
+		}
+		return escaped;
+	}
+}
+
+Profiler::Zone::Zone(Profiler* profiler, Phase phase)
+	: profiler(profiler)
+{
+	if (profiler)
+	{
+		profiler->begin(phase);
+	}
+}
+
+Profiler::Zone::~Zone()
+{
+	if (profiler)
+	{
+		profiler->end();
+	}
+}
+
+Profiler::Profiler(std::string file)
+	: file(std::move(file))
+{
+}
+
+void Profiler::begin(Phase phase)
+{
+	const auto now = Clock::now();
+	if (active_zones.empty())
+	{
+		thread = std::this_thread::get_id();
+	}
+	else
+	{
+		auto& parent = active_zones.back();
+		phase_times[static_cast<size_t>(parent.phase)] += now - parent.resumed;
+	}
+
+	active_zones.push_back({ .phase = phase, .start = now, .resumed = now });
+}
+
+void Profiler::end()
+{
+	assert(!active_zones.empty() && "Zones need to end in the reverse order they began");
+
+	const auto now = Clock::now();
+	const auto zone = active_zones.back();
+	active_zones.pop_back();
+
+	phase_times[static_cast<size_t>(zone.phase)] += now - zone.resumed;
+	events.push_back({ .phase = zone.phase, .start = zone.start, .duration = now - zone.start });
+
+	if (!active_zones.empty())
+	{
+		active_zones.back().resumed = now;
+	}
+}
+
+std::string_view to_string(Profiler::Phase phase)
+{
+	switch (phase)
+	{
+	case Profiler::Phase::Load: return "load";
+	case Profiler::Phase::Scan: return "scan";
+	case Profiler::Phase::Render: return "render";
+	case Profiler::Phase::Write: return "write";
+	}
+	return "unknown";
+}
+
+void print_statistics(std::ostream& out, std::span<const Profiler> profiles)
+{
+	std::vector<const Profiler*> slowest_first;
+	slowest_first.reserve(profiles.size());
+	for (auto& profile : profiles)
+	{
+		slowest_first.push_back(&profile);
+	}
+	std::ranges::stable_sort(slowest_first, std::greater{}, [](const Profiler* profile) { return get_total_time(*profile); });
+
+	const auto print_line = [&out](const Profiler& profile)
+	{
+		std::format_to(std::ostreambuf_iterator<char>{ out }, "{:>10.2f}{:>10.2f}{:>10.2f}{:>10.2f}{:>10.2f}{:>8}{:>8}{:>8}{:>12}  {}\n",
+			Milliseconds{ profile.phase_times[static_cast<size_t>(Profiler::Phase::Load)] }.count(),
+			Milliseconds{ profile.phase_times[static_cast<size_t>(Profiler::Phase::Scan)] }.count(),
+			Milliseconds{ profile.phase_times[static_cast<size_t>(Profiler::Phase::Render)] }.count(),
+			Milliseconds{ profile.phase_times[static_cast<size_t>(Profiler::Phase::Write)] }.count(),
+			Milliseconds{ get_total_time(profile) }.count(),
+			profile.type_count, profile.field_count, profile.method_count, profile.unsupported_type_count, profile.file);
+	};
+
+	std::format_to(std::ostreambuf_iterator<char>{ out }, "{:>10}{:>10}{:>10}{:>10}{:>10}{:>8}{:>8}{:>8}{:>12}  {}\n",
+		"load ms", "scan ms", "render ms", "write ms", "total ms", "types", "fields", "methods", "unsupported", "file");
+
+	Profiler total{ "(total)" };
+	for (const Profiler* profile : slowest_first)
+	{
+		print_line(*profile);
+
+		for (size_t i = 0; i < Profiler::phase_count; i++)
+		{
+			total.phase_times[i] += profile->phase_times[i];
+		}
+		total.type_count += profile->type_count;
+		total.field_count += profile->field_count;
+		total.method_count += profile->method_count;
+		total.unsupported_type_count += profile->unsupported_type_count;
+	}
+	print_line(total);
+}
+
+bool write_chrome_trace(const std::filesystem::path& file, std::span<const Profiler> profiles)
+{
+	auto trace_start = Profiler::Clock::time_point::max();
+	for (auto& profile : profiles)
+	{
+		for (auto& event : profile.events)
+		{
+			trace_start = std::min(trace_start, event.start);
+		}
+	}
+
+	std::unordered_map<std::thread::id, size_t> thread_indices; // Small numbers read better than the native ids
+	std::string trace = "{\"traceEvents\":[\n";
+	bool is_first_event = true;
+	const auto add_event = [&](std::string_view name, Profiler::Clock::time_point start, Profiler::Clock::duration duration, size_t thread_index, std::string_view file)
+	{
+		std::format_to(std::back_inserter(trace), R"({}{{"name":"{}","cat":"codegen","ph":"X","ts":{:.3f},"dur":{:.3f},"pid":1,"tid":{},"args":{{"file":"{}"}}}})",
+			(is_first_event ? "" : ",\n"), escape_json(name), Microseconds{ start - trace_start }.count(), Microseconds{ duration }.count(),
+			thread_index, escape_json(file));
+		is_first_event = false;
+	};
+
+	for (auto& profile : profiles)
+	{
+		if (profile.events.empty())
+		{
+			continue;
+		}
+
+		const size_t thread_index = thread_indices.try_emplace(profile.thread, thread_indices.size()).first->second;
+
+		// Spans the whole conversion, so each file shows up as one bar with its phases below it
+		auto start = Profiler::Clock::time_point::max();
+		auto finish = Profiler::Clock::time_point::min();
+		for (auto& event : profile.events)
+		{
+			start = std::min(start, event.start);
+			finish = std::max(finish, event.start + event.duration);
+		}
+		add_event(std::filesystem::path{ profile.file }.filename().string(), start, finish - start, thread_index, profile.file);
+
+		for (auto& event : profile.events)
+		{
+			add_event(to_string(event.phase), event.start, event.duration, thread_index, profile.file);
+		}
+	}
+	trace += "\n]}\n";
+
+	return write_file_if_changed(file, trace);
+}
@@ -0,0 +1,62 @@
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "Neat/Reflection.h"
+#include "Neat/TemplateTypeId.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+import SyntheticModule0;
+
+
+TEST_CASE("Benchmark type lookups", "[benchmark]")
+{
+	using namespace std::string_view_literals;
+
+	REQUIRE(Neat::get_type<Synthetic::Type0>() != nullptr);
+
+	// Long enough to not fit in the small string buffer, so constructing a `std::string` allocates
+	constexpr auto type_name = "Synthetic::Type0"sv;
+	const auto type_id = Neat::get_id<Synthetic::Type0>();
+
+	BENCHMARK("get_type(std::string_view)")
+	{
+		return Neat::get_type(type_name);
+	};
+
+	// What every lookup used to cost, when the name had to be copied into a std::string to probe `by_type_name`
+	BENCHMARK("get_type(std::string{ std::string_view })")
+	{
+		const std::string owned_type_name{ type_name };
+		return Neat::get_type(owned_type_name);
+	};
+
+	BENCHMARK("get_type(TemplateTypeId)")
+	{
+		return Neat::get_type(type_id);
+	};
+
+	BENCHMARK("get_type<T>()")
+	{
+		return Neat::get_type<Synthetic::Type0>();
+	};
+
+	BENCHMARK("get_type(std::string_view) miss")
+	{
+		return Neat::get_type("Synthetic::NotAType"sv);
+	};
+}
+
+TEST_CASE("Benchmark iterating all types", "[benchmark]")
+{
+	BENCHMARK("get_types() and sum the field counts")
+	{
+		size_t field_count = 0;
+		for (const Neat::Type* type : Neat::get_types())
+		{
+			field_count += type->fields.size();
+		}
+		return field_count;
+	};
+}
@@ -0,0 +1,170 @@
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "Neat/Reflection.h"
+
+#include <algorithm>
+#include <any>
+#include <string_view>
+#include <vector>
+
+import SyntheticModule0;
+
+
+namespace
+{
+	const Neat::Field& require_field(const Neat::Type& type, std::string_view name)
+	{
+		auto it = std::ranges::find(type.fields, name, &Neat::Field::name);
+		REQUIRE(it != type.fields.end());
+		return *it;
+	}
+
+	const Neat::Method& require_method(const Neat::Type& type, std::string_view name)
+	{
+		auto it = std::ranges::find(type.methods, name, &Neat::Method::name);
+		REQUIRE(it != type.methods.end());
+		return *it;
+	}
+}
+
+TEST_CASE("Benchmark field access", "[benchmark]")
+{
+	Neat::Type* type = Neat::get_type<Synthetic::Type0>();
+	REQUIRE(type != nullptr);
+	const auto& field = require_field(*type, "weight");
+
+	Synthetic::Type0 object{};
+
+	BENCHMARK("Field::get_value")
+	{
+		return field.get_value(&object);
+	};
+
+	BENCHMARK("Field::set_value")
+	{
+		field.set_value(&object, 2.0);
+	};
+
+	BENCHMARK("Field::get<T>")
+	{
+		return field.get<double>(&object);
+	};
+
+	BENCHMARK("Field::set<T>")
+	{
+		return field.set(&object, 2.0);
+	};
+
+	BENCHMARK("Direct member access (baseline)")
+	{
+		object.weight = 2.0;
+		return object.weight;
+	};
+}
+
+TEST_CASE("Benchmark batched field access", "[benchmark]")
+{
+	Neat::Type* type = Neat::get_type<Synthetic::Type0>();
+	REQUIRE(type != nullptr);
+	const auto& field = require_field(*type, "weight");
+
+	std::vector<Synthetic::Type0> objects(10'000);
+	std::vector<double> values(objects.size());
+
+	BENCHMARK("Field::get<T> per object")
+	{
+		for (size_t i = 0; i < objects.size(); i++)
+		{
+			values[i] = *field.get<double>(&objects[i]);
+		}
+		return values.back();
+	};
+
+	BENCHMARK("Field::gather<T>")
+	{
+		field.gather(objects.data(), sizeof(Synthetic::Type0), objects.size(), values.data());
+		return values.back();
+	};
+
+	BENCHMARK("Field::scatter<T>")
+	{
+		return field.scatter(objects.data(), sizeof(Synthetic::Type0), objects.size(), values.data());
+	};
+
+	BENCHMARK("Direct member access (baseline)")
+	{
+		for (size_t i = 0; i < objects.size(); i++)
+		{
+			values[i] = objects[i].weight;
+		}
+		return values.back();
+	};
+}
+
+TEST_CASE("Benchmark finding members by name", "[benchmark]")
+{
+	Neat::Type* type = Neat::get_type<Synthetic::Type0>();
+	REQUIRE(type != nullptr);
+	REQUIRE(type->find_field("weight") != nullptr);
+	REQUIRE(type->find_method("set_value") != nullptr);
+
+	BENCHMARK("Type::find_field")
+	{
+		return type->find_field("weight");
+	};
+
+	BENCHMARK("Type::find_method")
+	{
+		return type->find_method("set_value");
+	};
+
+	BENCHMARK("Type::find_field miss")
+	{
+		return type->find_field("missing");
+	};
+
+	BENCHMARK("Linear search over fields (baseline)")
+	{
+		return std::ranges::find(type->fields, std::string_view{ "weight" }, &Neat::Field::name);
+	};
+}
+
+TEST_CASE("Benchmark method invocation", "[benchmark]")
+{
+	Neat::Type* type = Neat::get_type<Synthetic::Type0>();
+	REQUIRE(type != nullptr);
+	const auto& get_id = require_method(*type, "get_id");
+	const auto& set_value = require_method(*type, "set_value");
+
+	Synthetic::Type0 object{};
+
+	BENCHMARK("Method::invoke without arguments")
+	{
+		return get_id.invoke(&object, {});
+	};
+
+	BENCHMARK("Method::invoke with an argument")
+	{
+		std::any arguments[] = { 2.0f };
+		return set_value.invoke(&object, arguments);
+	};
+
+	BENCHMARK("Method::invoke_typed without arguments")
+	{
+		int id = 0;
+		get_id.invoke_typed(&object, nullptr, &id);
+		return id;
+	};
+
+	BENCHMARK("Method::invoke_typed with an argument")
+	{
+		float value = 2.0f;
+		void* arguments[] = { &value };
+		set_value.invoke_typed(&object, arguments, nullptr);
+	};
+
+	BENCHMARK("Direct call (baseline)")
+	{
+		return object.get_id();
+	};
+}
@@ -0,0 +1,36 @@
+#include "catch2/catch_session.hpp"
+#include "Neat/Reflection.h"
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <format>
+
+
+// Registered modules are resolved on their first lookup, which can only be measured once. So it's done before
+// Catch runs any of the benchmarks, which also makes sure they only measure resolved lookups.
+static void measure_startup()
+{
+	using Clock = std::chrono::steady_clock;
+	using Microseconds = std::chrono::duration<double, std::micro>;
+
+	const auto before_first_lookup = Clock::now();
+	const bool found = (Neat::get_type("Synthetic::Type0") != nullptr);
+	const auto after_first_lookup = Clock::now();
+	const auto type_count = Neat::get_types().size();
+	const auto after_all_resolved = Clock::now();
+
+	std::cout << std::format("Startup with {} reflected types (expected {}):\n", type_count, NEAT_REFLECTION_BENCHMARK_TYPE_COUNT);
+	std::cout << std::format("    first lookup (resolves one module):  {:>10.1f} us{}\n", 
+		Microseconds{ after_first_lookup - before_first_lookup }.count(), found ? "" : " (NOT FOUND)");
+	std::cout << std::format("    resolving all other modules:         {:>10.1f} us, {:.3f} us per type\n\n", 
+		Microseconds{ after_all_resolved - after_first_lookup }.count(),
+		Microseconds{ after_all_resolved - after_first_lookup }.count() / static_cast<double>(type_count));
+}
+
+int main(int argc, char* argv[])
+{
+	measure_startup();
+
+	return Catch::Session().run(argc, argv);
+}
@@ -1,9 +1,20 @@
 #include "catch2/catch_all.hpp"
 #include "Neat/Reflection.h"
+#include "Neat/Serialization.h"
+#include "Neat/Database.h"
+#include "Neat/Instrumentation.h"
+#include "DatabaseWriter.h"
 
 #include <string_view>
 #include <string>
 #include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <atomic>
 
 import TestModule1;
 
@@ -46,7 +57,7 @@ void check_method(const Neat::Method& method, Neat::TemplateTypeId object_type,
 	CHECK(method.object_type == object_type);
 	CHECK(method.return_type == return_type);
 	CHECK(method.name == name);
-	CHECK(method.argument_types == argument_types);
+	CHECK(std::ranges::equal(method.argument_types, argument_types));
 }
 
 TEST_CASE("Types have correct data")
@@ -72,7 +83,7 @@ TEST_CASE("Types have correct data")
 		CHECK(type->name == "MyStruct");
 		CHECK(type->id == Neat::get_id<MyStruct>());
 		const std::vector<Neat::BaseClass> type_expected_bases{ { Neat::get_id<MyBaseStruct>(), Neat::Access::Public } };
-		CHECK(type->bases == type_expected_bases);
+		CHECK(std::ranges::equal(type->bases, type_expected_bases));
 		REQUIRE(type->fields.size() == 1);
 		check_field(type->fields[0], type->id, Neat::get_id<double>(), "damage");
 		REQUIRE(type->methods.size() == 4);
@@ -113,6 +124,176 @@ TEST_CASE("Types have correct data")
 	}
 }
 
+TEST_CASE("Modules are resolved on first lookup")
+{
+	// Nothing from TestModule2 is imported or looked up anywhere else, so it's only resolved by this lookup
+	Neat::Type* type = Neat::get_type("MyStruct2");
+	REQUIRE(type != nullptr);
+	CHECK(type->name == "MyStruct2");
+	REQUIRE(type->fields.size() == 1);
+	CHECK(type->fields[0].type == Neat::get_id<double>());
+	CHECK(type->fields[0].object_type == type->id);
+
+	// Resolving the module registered all of its types
+	Neat::Type* base_type = Neat::get_type("MyBaseStruct2");
+	REQUIRE(base_type != nullptr);
+	const std::vector<Neat::BaseClass> type_expected_bases{ { base_type->id, Neat::Access::Public } };
+	CHECK(std::ranges::equal(type->bases, type_expected_bases));
+	CHECK(Neat::get_type(type->id) == type);
+}
+
+TEST_CASE("Types are added concurrently and keep their address")
+{
+	Neat::Type* my_struct = Neat::get_type<MyStruct>();
+	REQUIRE(my_struct != nullptr);
+
+	constexpr size_t thread_count = 4;
+	constexpr size_t types_per_thread = 1000;
+	static std::vector<std::string> names; // Registered types need to outlive the registration
+	names.clear();
+	for (size_t i = 0; i < thread_count * types_per_thread; i++)
+	{
+		names.push_back("ConcurrentlyAddedType" + std::to_string(i));
+	}
+
+	std::atomic<bool> lookups_failed = false;
+	{
+		std::vector<std::jthread> threads;
+		for (size_t thread = 0; thread < thread_count; thread++)
+		{
+			threads.emplace_back([thread]()
+			{
+				for (size_t i = thread * types_per_thread; i < (thread + 1) * types_per_thread; i++)
+				{
+					Neat::Type type{};
+					type.name = names[i];
+					type.id = Neat::generate_new_type_id();
+					Neat::add_type(std::move(type));
+				}
+			});
+			threads.emplace_back([my_struct, &lookups_failed]()
+			{
+				for (size_t i = 0; i < types_per_thread; i++)
+				{
+					if (Neat::get_type<MyStruct>() != my_struct || Neat::get_type("MyStruct") != my_struct)
+					{
+						lookups_failed = true;
+					}
+				}
+			});
+		}
+	} // jthreads join here
+
+	CHECK_FALSE(lookups_failed);
+	CHECK(Neat::get_type<MyStruct>() == my_struct);
+	for (auto& name : names)
+	{
+		Neat::Type* type = Neat::get_type(name);
+		REQUIRE(type != nullptr);
+		CHECK(type->name == name);
+	}
+}
+
+namespace
+{
+	struct RemovableType { int value; };
+
+	// What the generator emits for a module, so it can be added and removed like a reloaded DLL
+	static constinit Neat::Field removable_type_fields[] = { Neat::Field::create<RemovableType, int, &RemovableType::value>("value", Neat::Access::Public) };
+	static constinit Neat::Type removable_types[] = { Neat::Type::create<RemovableType>("RemovableType", {}, removable_type_fields, {}) };
+	static constinit Neat::Module removable_module{ "RemovableModule", removable_types };
+}
+
+TEST_CASE("Modules can be removed")
+{
+	const Neat::ModuleHandle handle = Neat::add_module(removable_module);
+	CHECK(Neat::is_registered(handle));
+	CHECK(Neat::add_module(removable_module) == handle); // Registered already, before it's resolved
+
+	Neat::Type* type = Neat::get_type<RemovableType>();
+	REQUIRE(type != nullptr);
+	CHECK(type == &removable_types[0]); // Resolved in place
+	CHECK(Neat::get_type("RemovableType") == type);
+	CHECK(std::ranges::count(Neat::get_types(), type) == 1);
+
+	CHECK(Neat::add_module(removable_module) == handle); // And after
+	CHECK(Neat::get_type("RemovableType") == type);
+	CHECK(std::ranges::count(Neat::get_types(), type) == 1);
+
+	CHECK(Neat::remove_module(handle));
+	CHECK_FALSE(Neat::is_registered(handle));
+	CHECK_FALSE(Neat::remove_module(handle)); // Stale
+	CHECK(Neat::get_type<RemovableType>() == nullptr);
+	CHECK(Neat::get_type("RemovableType") == nullptr);
+	CHECK(std::ranges::count(Neat::get_types(), type) == 0);
+	CHECK(Neat::get_type<MyStruct>() != nullptr);
+
+	SECTION("Adding it again gives a new handle") {
+		const Neat::ModuleHandle reloaded_handle = Neat::add_module(removable_module);
+		CHECK(reloaded_handle != handle);
+		CHECK_FALSE(Neat::is_registered(handle));
+		CHECK(Neat::get_type("RemovableType") == type);
+
+		CHECK(Neat::remove_module(reloaded_handle));
+	}
+}
+
+TEST_CASE("Modules are added concurrently")
+{
+	constexpr size_t thread_count = 4;
+	for (int round = 0; round < 100; round++)
+	{
+		Neat::ModuleHandle handles[thread_count];
+		{
+			std::vector<std::jthread> threads;
+			for (size_t thread = 0; thread < thread_count; thread++)
+			{
+				threads.emplace_back([&handles, thread]() { handles[thread] = Neat::add_module(removable_module); });
+			}
+		} // jthreads join here
+
+		// Only one of them registered it, the others got its handle
+		CHECK(std::ranges::all_of(handles, [&](const Neat::ModuleHandle& handle) { return handle == handles[0]; }));
+		CHECK(std::ranges::count(Neat::get_types(), &removable_types[0]) == 1);
+		REQUIRE(Neat::remove_module(handles[0]));
+		CHECK(Neat::get_type<RemovableType>() == nullptr);
+	}
+}
+
+TEST_CASE("Reloading a module doesn't grow the registry")
+{
+	// Like a DLL which is reloaded over and over: its types get new ids each time
+	Neat::Type reloaded_types[2];
+	Neat::Module reloaded_module{ "ReloadedModule", reloaded_types };
+
+	Neat::reset_statistics();
+	for (int i = 0; i < 200; i++)
+	{
+		reloaded_types[0] = Neat::Type{};
+		reloaded_types[0].name = "ReloadedType";
+		reloaded_types[0].id = Neat::generate_new_type_id();
+		reloaded_types[1] = Neat::Type{};
+		reloaded_types[1].name = "ReloadedType2";
+		reloaded_types[1].id = Neat::generate_new_type_id();
+
+		const Neat::ModuleHandle handle = Neat::add_module(reloaded_module);
+		REQUIRE(Neat::get_type(reloaded_types[1].id) == &reloaded_types[1]);
+		CHECK(Neat::get_type("ReloadedType") == &reloaded_types[0]);
+		CHECK(std::ranges::count(Neat::get_types(), &reloaded_types[0]) == 1);
+		CHECK(Neat::remove_module(handle));
+		CHECK(Neat::get_type(reloaded_types[1].id) == nullptr);
+	}
+	CHECK(Neat::get_type<MyStruct>() != nullptr);
+
+	if constexpr (Neat::has_instrumentation)
+	{
+		const Neat::Statistics statistics = Neat::get_statistics();
+		REQUIRE(statistics.modules.size() == 200);
+		// The tables and the type list only grow while warming up, afterwards the space of removed types is reused
+		CHECK(std::all_of(statistics.modules.begin() + 100, statistics.modules.end(), [](const Neat::ModuleStatistics& module) { return module.allocated_bytes == 0; }));
+	}
+}
+
 TEST_CASE("Namespaced types have correct data")
 {
 	SECTION("ExportedNamespace::StillExportedClass") {
@@ -219,6 +400,633 @@ TEST_CASE("Write field values")
 	}
 }
 
+TEST_CASE("Typed field access")
+{
+	MyStruct my_struct{ .damage = 42.0 };
+
+	Neat::Type* type = Neat::get_type<MyStruct>();
+	REQUIRE(type != nullptr);
+
+	REQUIRE(!type->fields.empty());
+	auto& field = type->fields[0];
+	REQUIRE(field.name == "damage");
+
+	SECTION("address_of") {
+		CHECK(field.address_of(&my_struct) == &my_struct.damage);
+	}
+
+	SECTION("get") {
+		double* value = field.get<double>(&my_struct);
+		REQUIRE(value != nullptr);
+		CHECK(value == &my_struct.damage);
+		CHECK(*value == Catch::Approx(42.0));
+
+		CHECK(field.get<int>(&my_struct) == nullptr); // Mismatching type
+	}
+
+	SECTION("set") {
+		CHECK(field.set(&my_struct, 7.0));
+		CHECK(my_struct.damage == Catch::Approx(7.0));
+
+		CHECK(!field.set(&my_struct, 5)); // Mismatching type
+		CHECK(my_struct.damage == Catch::Approx(7.0));
+	}
+}
+
+TEST_CASE("Batched field access")
+{
+	MyStruct my_structs[3]{};
+	for (size_t i = 0; i < std::size(my_structs); i++)
+	{
+		my_structs[i].health = 1;
+		my_structs[i].damage = static_cast<double>(i);
+	}
+
+	Neat::Type* type = Neat::get_type<MyStruct>();
+	REQUIRE(type != nullptr);
+
+	REQUIRE(!type->fields.empty());
+	auto& field = type->fields[0];
+	REQUIRE(field.name == "damage");
+
+	SECTION("gather") {
+		double values[3]{};
+		REQUIRE(field.gather(my_structs, sizeof(MyStruct), std::size(my_structs), values));
+		CHECK(values[0] == Catch::Approx(0.0));
+		CHECK(values[2] == Catch::Approx(2.0));
+
+		int mismatching_values[3]{};
+		CHECK(!field.gather(my_structs, sizeof(MyStruct), std::size(my_structs), mismatching_values));
+	}
+
+	SECTION("scatter") {
+		const double values[] = { 5.0, 6.0, 7.0 };
+		REQUIRE(field.scatter(my_structs, sizeof(MyStruct), std::size(my_structs), values));
+		CHECK(my_structs[0].damage == Catch::Approx(5.0));
+		CHECK(my_structs[2].damage == Catch::Approx(7.0));
+		CHECK(my_structs[2].health == 1); // Only the field is written
+	}
+}
+
+TEST_CASE("Find members by name")
+{
+	Neat::Type* type = Neat::get_type<MyStruct>();
+	REQUIRE(type != nullptr);
+
+	CHECK(type->find_field("damage") == &type->fields[0]);
+	CHECK(type->find_field("health") == nullptr); // Inherited, only the type's own fields are indexed
+	CHECK(type->find_field("") == nullptr);
+
+	for (auto& method : type->methods)
+	{
+		CHECK(type->find_method(method.name) == &method);
+	}
+	CHECK(type->find_method("damage") == nullptr);
+	CHECK(type->find_field("get_42") == nullptr);
+
+	Neat::Type* empty_type = Neat::get_type<ExportedNamespace::StillExportedClass>();
+	REQUIRE(empty_type != nullptr);
+	CHECK(empty_type->find_field("damage") == nullptr);
+	CHECK(empty_type->find_method("get_42") == nullptr);
+}
+
+TEST_CASE("Construct objects in place")
+{
+	Neat::Type* type = Neat::get_type<MyClass>();
+	REQUIRE(type != nullptr);
+	CHECK(type->size == sizeof(MyClass));
+	CHECK(type->alignment == alignof(MyClass));
+
+	constexpr size_t count = 3;
+	alignas(MyClass) std::byte buffer[count * sizeof(MyClass)];
+	alignas(MyClass) std::byte copy_buffer[count * sizeof(MyClass)];
+	auto* objects = reinterpret_cast<MyClass*>(buffer);
+	auto* copies = reinterpret_cast<MyClass*>(copy_buffer);
+
+	REQUIRE(type->default_construct(buffer, count));
+	CHECK(objects[count - 1].i == 42);
+
+	objects[0].i = 7;
+	CHECK_FALSE(type->copy_construct(copy_buffer, buffer, count)); // Not enabled yet
+	REQUIRE(Neat::enable_copy_construction<MyClass>());
+	REQUIRE(Neat::enable_move_construction<MyClass>());
+	REQUIRE(type->copy_construct(copy_buffer, buffer, count));
+	CHECK(copies[0].i == 7);
+	CHECK(copies[1].i == 42);
+	CHECK(type->destroy(copy_buffer, count));
+
+	REQUIRE(type->move_construct(copy_buffer, buffer, count));
+	CHECK(copies[0].i == 7);
+	CHECK(type->destroy(copy_buffer, count));
+	CHECK(type->destroy(buffer, count));
+
+	Neat::Type runtime_type{}; // Not a C++ type, it can't be constructed
+	CHECK(runtime_type.size == 0);
+	CHECK_FALSE(runtime_type.default_construct(buffer));
+	CHECK_FALSE(runtime_type.destroy(buffer));
+}
+
+struct MoveOnlyHolder
+{
+	std::vector<std::unique_ptr<int>> values;
+};
+
+TEST_CASE("Construct objects with a move only member container")
+{
+	static_assert(std::is_copy_constructible_v<MoveOnlyHolder>); // But its copy constructor doesn't compile
+	Neat::Type& type = Neat::add_type(Neat::Type::create<MoveOnlyHolder>("MoveOnlyHolder", {}, {}, {}));
+	CHECK(type.copy_constructor == nullptr);
+	CHECK(type.move_constructor == nullptr);
+	REQUIRE(Neat::enable_move_construction<MoveOnlyHolder>());
+
+	alignas(MoveOnlyHolder) std::byte buffer[sizeof(MoveOnlyHolder)];
+	alignas(MoveOnlyHolder) std::byte moved_buffer[sizeof(MoveOnlyHolder)];
+	REQUIRE(type.default_construct(buffer));
+	reinterpret_cast<MoveOnlyHolder*>(buffer)->values.push_back(std::make_unique<int>(7));
+
+	REQUIRE(type.move_construct(moved_buffer, buffer));
+	auto* moved = reinterpret_cast<MoveOnlyHolder*>(moved_buffer);
+	REQUIRE(moved->values.size() == 1);
+	CHECK(*moved->values[0] == 7);
+	CHECK_FALSE(type.copy_construct(buffer, moved_buffer));
+	CHECK(type.destroy(moved_buffer));
+	CHECK(type.destroy(buffer));
+}
+
+TEST_CASE("Field layout")
+{
+	SECTION("MyStruct") {
+		MyStruct my_struct{};
+
+		Neat::Type* type = Neat::get_type<MyStruct>();
+		REQUIRE(type != nullptr);
+
+		REQUIRE(type->fields.size() == 1);
+		auto& field = type->fields[0];
+		REQUIRE(field.name == "damage");
+
+		const auto expected_offset = reinterpret_cast<std::byte*>(&my_struct.damage) - reinterpret_cast<std::byte*>(&my_struct);
+		CHECK(field.offset == static_cast<size_t>(expected_offset));
+		CHECK(field.size == sizeof(double));
+		CHECK(field.alignment == alignof(double));
+		CHECK(field.is_trivially_copyable);
+		CHECK(type->has_contiguous_trivially_copyable_fields);
+	}
+
+	SECTION("MyClass") {
+		Neat::Type* type = Neat::get_type<MyClass>();
+		REQUIRE(type != nullptr);
+
+		// `ptr_to_unexported` sits in between the reflected `i` and `d`
+		REQUIRE(type->fields.size() == 2);
+		CHECK(type->fields[0].offset < type->fields[1].offset);
+		CHECK(!type->has_contiguous_trivially_copyable_fields);
+	}
+}
+
+struct BigObject
+{
+	std::byte data[16 * 1024 * 1024]; // Bigger than a thread's stack
+	int last;
+};
+
+struct BigDerived : MyBaseStruct, BigObject {};
+
+TEST_CASE("Field layout of big types")
+{
+	static Neat::Field fields[] = { Neat::Field::create<BigObject, int, &BigObject::last>("last", Neat::Access::Public) };
+	Neat::Type& type = Neat::add_type(Neat::Type::create<BigObject>("BigObject", {}, fields, {}));
+	CHECK(type.fields[0].offset == offsetof(BigObject, last));
+
+	static Neat::BaseClass bases[] = { 
+		Neat::BaseClass::create<BigDerived, MyBaseStruct>(Neat::Access::Public),
+		Neat::BaseClass::create<BigDerived, BigObject>(Neat::Access::Public)
+	};
+	Neat::Type& derived_type = Neat::add_type(Neat::Type::create<BigDerived>("BigDerived", bases, {}, {}));
+	static BigDerived derived; // Static, it doesn't fit on the stack either
+	CHECK(derived_type.bases[1].offset == reinterpret_cast<std::byte*>(static_cast<BigObject*>(&derived)) - reinterpret_cast<std::byte*>(&derived));
+}
+
+TEST_CASE("Inheritance")
+{
+	Neat::Type* type = Neat::get_type<MyStruct>();
+	Neat::Type* base_type = Neat::get_type<MyBaseStruct>();
+	REQUIRE(type != nullptr);
+	REQUIRE(base_type != nullptr);
+
+	SECTION("Derived from") {
+		CHECK(type->is_derived_from<MyBaseStruct>());
+		CHECK(!type->is_derived_from<MyStruct>());
+		CHECK(!base_type->is_derived_from<MyStruct>());
+		CHECK(!type->is_derived_from<MyClass>());
+	}
+
+	SECTION("Upcast") {
+		MyStruct my_struct{};
+		CHECK(type->upcast(&my_struct, Neat::get_id<MyBaseStruct>()) == static_cast<MyBaseStruct*>(&my_struct));
+		CHECK(type->upcast(&my_struct, Neat::get_id<MyClass>()) == nullptr);
+	}
+
+	SECTION("Inherited fields") {
+		MyStruct my_struct{};
+		my_struct.health = 7;
+
+		const Neat::Inheritance& inheritance = type->get_inheritance();
+		CHECK(&inheritance == &type->get_inheritance()); // Computed once
+
+		REQUIRE(inheritance.bases.size() == 1);
+		CHECK(inheritance.bases[0].base_id == Neat::get_id<MyBaseStruct>());
+		CHECK(inheritance.bases[0].has_fixed_offset);
+
+		// Own fields first
+		REQUIRE(inheritance.fields.size() == 2);
+		CHECK(inheritance.fields[0].field->name == "damage");
+		CHECK(inheritance.fields[0].base == nullptr);
+		CHECK(inheritance.fields[1].field->name == "health");
+		CHECK(inheritance.fields[1].base == &inheritance.bases[0]);
+		CHECK(inheritance.fields[1].address_of(&my_struct) == &my_struct.health);
+	}
+}
+
+TEST_CASE("Serialization")
+{
+	MyStruct my_struct{};
+	my_struct.health = 7;
+	my_struct.damage = 42.0;
+
+	std::vector<std::byte> data;
+	REQUIRE(Neat::serialize(my_struct, data));
+
+	SECTION("Plan") {
+		Neat::Type* type = Neat::get_type<MyStruct>();
+		REQUIRE(type != nullptr);
+
+		const Neat::SerializationPlan& plan = Neat::get_serialization_plan(*type);
+		CHECK(&plan == &Neat::get_serialization_plan(*type)); // Compiled once
+		CHECK(plan.payload_size == sizeof(int) + sizeof(double)); // The inherited `health` too, without padding
+		CHECK(plan.skipped_fields.empty());
+		CHECK(plan.schema_hash == Neat::compile_serialization_plan(*type).schema_hash);
+		CHECK(data.size() == Neat::serialization_header_size + plan.payload_size);
+	}
+
+	SECTION("Round trip") {
+		MyStruct read{};
+		std::span<const std::byte> in{ data };
+		REQUIRE(Neat::deserialize(read, in));
+		CHECK(in.empty());
+		CHECK(read.health == 7);
+		CHECK(read.damage == Catch::Approx(42.0));
+	}
+
+	SECTION("Other schema") {
+		MyBaseStruct read{ .health = 0 };
+		std::span<const std::byte> in{ data };
+		CHECK(!Neat::deserialize(read, in));
+		CHECK(in.size() == data.size());
+		CHECK(read.health == 0);
+	}
+
+	SECTION("Cut off") {
+		data.pop_back();
+
+		MyStruct read{};
+		std::span<const std::byte> in{ data };
+		CHECK(!Neat::deserialize(read, in));
+	}
+}
+
+struct WithPointers
+{
+	int value;
+	int* pointer;
+	int WithPointers::* member;
+};
+
+struct IntVersion { int value; };
+struct FloatVersion { float value; };
+
+TEST_CASE("Serialization of pointers and changed field types")
+{
+	static Neat::Field fields[] = {
+		Neat::Field::create<WithPointers, int, &WithPointers::value>("value", Neat::Access::Public),
+		Neat::Field::create<WithPointers, int*, &WithPointers::pointer>("pointer", Neat::Access::Public),
+		Neat::Field::create<WithPointers, int WithPointers::*, &WithPointers::member>("member", Neat::Access::Public)
+	};
+	Neat::Type& type = Neat::add_type(Neat::Type::create<WithPointers>("WithPointers", {}, fields, {}));
+
+	const Neat::SerializationPlan& plan = Neat::get_serialization_plan(type);
+	CHECK(plan.payload_size == sizeof(int)); // Pointers are trivially copyable, but their values can't be serialized
+	CHECK(plan.skipped_fields == std::vector<std::string>{ "pointer", "member" });
+
+	// Same names and sizes, only the type of the field changed
+	static Neat::Field int_fields[] = { Neat::Field::create<IntVersion, int, &IntVersion::value>("value", Neat::Access::Public) };
+	static Neat::Field float_fields[] = { Neat::Field::create<FloatVersion, float, &FloatVersion::value>("value", Neat::Access::Public) };
+	const Neat::Type int_version = Neat::Type::create<IntVersion>("Versioned", {}, int_fields, {});
+	const Neat::Type float_version = Neat::Type::create<FloatVersion>("Versioned", {}, float_fields, {});
+	CHECK(Neat::compile_serialization_plan(int_version).schema_hash != Neat::compile_serialization_plan(float_version).schema_hash);
+}
+
+struct PointerNode
+{
+	int* pointer;
+	int value;
+};
+
+struct PointerHolder
+{
+	PointerNode node;
+	int count;
+};
+
+TEST_CASE("Serialization of pointers in nested types")
+{
+	static Neat::Field node_fields[] = {
+		Neat::Field::create<PointerNode, int*, &PointerNode::pointer>("pointer", Neat::Access::Public),
+		Neat::Field::create<PointerNode, int, &PointerNode::value>("value", Neat::Access::Public)
+	};
+	static Neat::Field holder_fields[] = {
+		Neat::Field::create<PointerHolder, PointerNode, &PointerHolder::node>("node", Neat::Access::Public),
+		Neat::Field::create<PointerHolder, int, &PointerHolder::count>("count", Neat::Access::Public)
+	};
+	Neat::add_type(Neat::Type::create<PointerNode>("PointerNode", {}, node_fields, {}));
+	Neat::Type& holder = Neat::add_type(Neat::Type::create<PointerHolder>("PointerHolder", {}, holder_fields, {}));
+
+	// The node is trivially copyable, but it's still expanded so its pointer isn't copied
+	const Neat::SerializationPlan& plan = Neat::get_serialization_plan(holder);
+	CHECK(plan.payload_size == 2 * sizeof(int));
+	CHECK(plan.skipped_fields == std::vector<std::string>{ "node.pointer" });
+}
+
+namespace
+{
+	struct VersionedNode
+	{
+		int first;
+		int second;
+	};
+
+	struct VersionedHolder { VersionedNode node; };
+
+	// Two versions of a module with the same types, the second one renamed a field of the nested type
+	static constinit Neat::Field holder_v1_fields[] = { Neat::Field::create<VersionedHolder, VersionedNode, &VersionedHolder::node>("node", Neat::Access::Public) };
+	static constinit Neat::Field holder_v2_fields[] = { Neat::Field::create<VersionedHolder, VersionedNode, &VersionedHolder::node>("node", Neat::Access::Public) };
+	static constinit Neat::Field node_v1_fields[] = {
+		Neat::Field::create<VersionedNode, int, &VersionedNode::first>("first", Neat::Access::Public),
+		Neat::Field::create<VersionedNode, int, &VersionedNode::second>("second", Neat::Access::Public)
+	};
+	static constinit Neat::Field node_v2_fields[] = {
+		Neat::Field::create<VersionedNode, int, &VersionedNode::first>("renamed", Neat::Access::Public),
+		Neat::Field::create<VersionedNode, int, &VersionedNode::second>("second", Neat::Access::Public)
+	};
+	static constinit Neat::Type v1_types[] = {
+		Neat::Type::create<VersionedHolder>("VersionedHolder", {}, holder_v1_fields, {}),
+		Neat::Type::create<VersionedNode>("VersionedNode", {}, node_v1_fields, {})
+	};
+	static constinit Neat::Type v2_types[] = {
+		Neat::Type::create<VersionedHolder>("VersionedHolder", {}, holder_v2_fields, {}),
+		Neat::Type::create<VersionedNode>("VersionedNode", {}, node_v2_fields, {})
+	};
+	static constinit Neat::Module v1_module{ "VersionedModule", v1_types };
+	static constinit Neat::Module v2_module{ "VersionedModule", v2_types };
+}
+
+TEST_CASE("Serialization of changed nested types")
+{
+	const auto compile_with = [](Neat::Module& module)
+	{
+		const Neat::ModuleHandle handle = Neat::add_module(module);
+		Neat::Type* holder = Neat::get_type<VersionedHolder>();
+		REQUIRE(holder != nullptr);
+		const Neat::SerializationPlan plan = Neat::compile_serialization_plan(*holder);
+		CHECK(Neat::remove_module(handle));
+		return plan;
+	};
+	const Neat::SerializationPlan v1 = compile_with(v1_module);
+	const Neat::SerializationPlan v2 = compile_with(v2_module);
+
+	// Same size and the same type of the field, only the layout of the nested type changed
+	CHECK(v1.payload_size == v2.payload_size);
+	CHECK(v1.schema_hash != v2.schema_hash);
+}
+
+struct VersionedOuter { VersionedNode node; };
+
+TEST_CASE("Serialization plans are dropped with their module")
+{
+	// Like a DLL which is reloaded at the same address, its types keep their ids but the layout changed
+	Neat::Type reloaded_types[2];
+	Neat::Module reloaded_module{ "VersionedModule", reloaded_types };
+
+	// Outlives the module, but depends on it
+	static Neat::Field outer_fields[] = { Neat::Field::create<VersionedOuter, VersionedNode, &VersionedOuter::node>("node", Neat::Access::Public) };
+	Neat::Type& outer = Neat::add_type(Neat::Type::create<VersionedOuter>("VersionedOuter", {}, outer_fields, {}));
+
+	reloaded_types[0] = Neat::Type::create<VersionedHolder>("VersionedHolder", {}, holder_v1_fields, {});
+	reloaded_types[1] = Neat::Type::create<VersionedNode>("VersionedNode", {}, node_v1_fields, {});
+	Neat::ModuleHandle handle = Neat::add_module(reloaded_module);
+	REQUIRE(Neat::get_type<VersionedHolder>() == &reloaded_types[0]);
+	const uint64_t v1_hash = Neat::get_serialization_plan(reloaded_types[0]).schema_hash;
+	const Neat::SerializationPlan& v1_outer_plan = Neat::get_serialization_plan(outer);
+	const uint64_t v1_outer_hash = v1_outer_plan.schema_hash;
+	CHECK(Neat::remove_module(handle));
+
+	reloaded_types[0] = Neat::Type::create<VersionedHolder>("VersionedHolder", {}, holder_v2_fields, {});
+	reloaded_types[1] = Neat::Type::create<VersionedNode>("VersionedNode", {}, node_v2_fields, {});
+	handle = Neat::add_module(reloaded_module);
+	REQUIRE(Neat::get_type<VersionedHolder>() == &reloaded_types[0]);
+	CHECK(Neat::get_serialization_plan(reloaded_types[0]).schema_hash != v1_hash);
+	CHECK(Neat::get_serialization_plan(reloaded_types[0]).schema_hash == Neat::compile_serialization_plan(reloaded_types[0]).schema_hash);
+	CHECK(Neat::get_serialization_plan(outer).schema_hash != v1_outer_hash);
+	CHECK(v1_outer_plan.schema_hash == v1_outer_hash); // Replaced, but still valid
+	CHECK(Neat::remove_module(handle));
+}
+
+TEST_CASE("Database")
+{
+	// Only a header and an empty string table, databases with types are written by the generator
+	Neat::DatabaseFormat::Header header{};
+	header.magic = Neat::DatabaseFormat::magic;
+	header.version = Neat::DatabaseFormat::version;
+	header.file_size = sizeof(header);
+	header.types = header.bases = header.fields = header.methods = header.arguments = header.enumerators = header.strings = { .offset = 0, .count = 0 };
+
+	const auto data = std::as_bytes(std::span{ &header, 1 });
+
+	SECTION("Empty") {
+		Neat::Database database;
+		REQUIRE(database.open(data));
+		CHECK(database.is_open());
+		CHECK(database.get_types().empty());
+		CHECK(database.get_module_name().empty());
+		CHECK(database.find_type("MyStruct") == nullptr);
+	}
+
+	SECTION("Invalid") {
+		Neat::Database database;
+		CHECK_FALSE(database.open(data.first(data.size() - 1))); // Cut off
+
+		header.version++;
+		CHECK_FALSE(database.open(data));
+		header.version--;
+
+		header.types = { .offset = sizeof(header), .count = 1 }; // Past the end
+		CHECK_FALSE(database.open(data));
+		CHECK_FALSE(database.is_open());
+	}
+}
+
+TEST_CASE("Database written by DatabaseWriter")
+{
+	DatabaseWriter writer;
+	writer.add_type({
+		.name = "MyStruct",
+		.bases = { { .name = "MyBaseStruct", .access = Neat::Access::Public } },
+		.fields = { { .name = "damage", .type_name = "double", .access = Neat::Access::Public } },
+		.methods = { { .name = "argumented_function", .return_type_name = "void", .argument_type_names = { "int", "int" }, .access = Neat::Access::Public } } });
+	writer.add_type({
+		.name = "MyEnum",
+		.kind = Neat::DatabaseFormat::TypeKind::Enum,
+		.enumerators = { { .name = "Zero", .value = 0 }, { .name = "Two", .value = 2 }, { .name = "MinusOne", .value = -1 } } });
+	const std::string file = writer.write("TestModule1");
+
+	// Copied, so it's aligned like a memory mapped file
+	std::vector<uint64_t> aligned_file((file.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+	std::memcpy(aligned_file.data(), file.data(), file.size());
+
+	Neat::Database database;
+	REQUIRE(database.open(std::as_bytes(std::span{ aligned_file }).first(file.size())));
+	CHECK(database.get_module_name() == "TestModule1");
+	CHECK(database.get_types().size() == 2);
+
+	const auto* my_struct = database.find_type("MyStruct");
+	REQUIRE(my_struct != nullptr);
+	CHECK(my_struct->id == Neat::get_stable_type_id("MyStruct"));
+	CHECK(database.get_string(my_struct->name) == "MyStruct");
+	CHECK(my_struct->kind == Neat::DatabaseFormat::TypeKind::Class);
+	CHECK(database.get_enumerators(*my_struct).empty());
+
+	REQUIRE(database.get_bases(*my_struct).size() == 1);
+	CHECK(database.get_bases(*my_struct)[0].id == Neat::get_stable_type_id("MyBaseStruct"));
+	CHECK(database.get_bases(*my_struct)[0].access == Neat::Access::Public);
+
+	REQUIRE(database.get_fields(*my_struct).size() == 1);
+	const auto& field = database.get_fields(*my_struct)[0];
+	CHECK(database.get_string(field.name) == "damage");
+	CHECK(database.get_string(field.type_name) == "double");
+	CHECK(field.type == Neat::get_stable_type_id("double"));
+	CHECK(field.access == Neat::Access::Public);
+
+	REQUIRE(database.get_methods(*my_struct).size() == 1);
+	const auto& method = database.get_methods(*my_struct)[0];
+	CHECK(database.get_string(method.name) == "argumented_function");
+	CHECK(method.return_type == Neat::get_stable_type_id("void"));
+	REQUIRE(database.get_arguments(method).size() == 2);
+	CHECK(database.get_string(database.get_arguments(method)[1].type_name) == "int");
+
+	const auto* my_enum = database.find_type("MyEnum");
+	REQUIRE(my_enum != nullptr);
+	CHECK(my_enum->kind == Neat::DatabaseFormat::TypeKind::Enum);
+	CHECK(database.get_fields(*my_enum).empty());
+	const auto enumerators = database.get_enumerators(*my_enum);
+	REQUIRE(enumerators.size() == 3);
+	CHECK(database.get_string(enumerators[0].name) == "Zero");
+	CHECK(enumerators[0].value == 0);
+	CHECK(database.get_string(enumerators[2].name) == "MinusOne");
+	CHECK(enumerators[2].value == -1);
+
+	SECTION("Enumerators out of range") {
+		const_cast<Neat::Database::TypeRecord*>(my_enum)->enumerators.count = 4; // The records are read in place
+		CHECK_FALSE(database.open(std::as_bytes(std::span{ aligned_file }).first(file.size())));
+	}
+}
+
+TEST_CASE("Stable type ids")
+{
+	static_assert(Neat::get_stable_type_id("MyStruct") == Neat::get_stable_type_id("MyStruct"));
+	CHECK(Neat::get_stable_type_id("MyStruct") != Neat::get_stable_type_id("MyBaseStruct"));
+	CHECK(Neat::get_stable_type_id("") == 0xCBF29CE484222325); // FNV-1a offset basis, the ids have to stay the same
+
+	// The same as the generator's, which hashes the names it renders
+	static_assert(Neat::get_stable_id<MyStruct>() == Neat::get_stable_id<MyStruct>());
+	CHECK(Neat::get_stable_id<MyStruct>() == Neat::get_stable_type_id("MyStruct"));
+	CHECK(Neat::get_stable_id<ExportedNamespace::StillExportedClass>() == Neat::get_stable_type_id("ExportedNamespace::StillExportedClass"));
+	CHECK(Neat::get_stable_id<const char*>() == Neat::get_stable_type_id("const char*"));
+
+	if constexpr (Neat::has_stable_type_ids)
+	{
+		CHECK(Neat::get_id<MyStruct>() == Neat::get_stable_type_id("MyStruct"));
+		CHECK(Neat::get_type(Neat::get_stable_type_id("MyStruct")) == Neat::get_type<MyStruct>());
+	}
+}
+
+TEST_CASE("Enums")
+{
+	Neat::Type* type = Neat::get_type<MyEnum>();
+	REQUIRE(type != nullptr);
+	REQUIRE(type->enumeration != nullptr);
+	CHECK(type->name == "MyEnum");
+	CHECK(type->fields.empty());
+
+	const Neat::Enum& enumeration = *type->enumeration;
+	CHECK(enumeration.underlying_type == Neat::get_id<short>());
+	REQUIRE(enumeration.enumerators.size() == 4);
+	REQUIRE(enumeration.by_value.size() == 4);
+	CHECK(std::ranges::is_sorted(enumeration.enumerators, {}, &Neat::Enumerator::name));
+	CHECK(std::ranges::is_sorted(enumeration.by_value, {}, &Neat::Enumerator::value));
+
+	SECTION("Names to values") {
+		MyEnum value = MyEnum::Zero;
+		CHECK(enumeration.to_value("MinusOne", value));
+		CHECK(value == MyEnum::MinusOne);
+		CHECK(enumeration.to_value("Two", value));
+		CHECK(value == MyEnum::Two);
+		CHECK_FALSE(enumeration.to_value("Three", value));
+		CHECK(value == MyEnum::Two);
+	}
+
+	SECTION("Values to names") {
+		CHECK(enumeration.to_name(MyEnum::Zero) == "Zero");
+		CHECK(enumeration.to_name(MyEnum::MinusOne) == "MinusOne");
+		CHECK(enumeration.to_name(MyEnum::Two) == "AlsoTwo"); // Shares its value, the first by name wins
+		CHECK(enumeration.to_name(static_cast<MyEnum>(3)).empty());
+	}
+}
+
+TEST_CASE("Instrumentation")
+{
+	REQUIRE(Neat::get_type<MyStruct>() != nullptr); // Resolves the module
+	Neat::reset_statistics();
+
+	Neat::get_type("MyStruct");
+	Neat::get_type("NoSuchType");
+	Neat::get_type<MyBaseStruct>();
+
+	Neat::Type added_type{};
+	added_type.name = "InstrumentationTestType";
+	added_type.id = Neat::generate_new_type_id();
+	Neat::add_type(std::move(added_type));
+
+	const Neat::Statistics statistics = Neat::get_statistics();
+	if constexpr (Neat::has_instrumentation)
+	{
+		CHECK(statistics.lookups_by_name.hits == 1);
+		CHECK(statistics.lookups_by_name.misses == 1);
+		CHECK(statistics.lookups_by_name.get_hit_rate() == 0.5);
+		CHECK(statistics.lookups_by_id.hits == 1);
+		CHECK(statistics.lookups_by_id.misses == 0);
+		CHECK(statistics.added_type_count == 1);
+		CHECK(statistics.modules.empty()); // Resolved before the statistics were reset
+	}
+	else
+	{
+		CHECK(statistics.lookups_by_name.get_count() == 0);
+		CHECK(statistics.lookups_by_id.get_count() == 0);
+		CHECK(statistics.added_type_count == 0);
+		CHECK(statistics.added_type_bytes == 0);
+		CHECK(statistics.modules.empty());
+	}
+}
+
 TEST_CASE("Invoke method")
 {
 	MyStruct my_struct{ .damage = -5.0 };
@@ -257,3 +1065,36 @@ TEST_CASE("Invoke method 2")
 	REQUIRE(std::string(value_charptr) == "prefix: 6 2.3");
 }
 
+
+TEST_CASE("Invoke method typed")
+{
+	MyStruct my_struct{ .damage = -5.0 };
+
+	Neat::Type* type = Neat::get_type<MyStruct>();
+	REQUIRE(type != nullptr);
+	REQUIRE(type->methods.size() == 4);
+
+	SECTION("get_42") {
+		auto& method = type->methods[2];
+		REQUIRE(method.name == "get_42");
+
+		int value = 0;
+		method.invoke_typed(&my_struct, nullptr, &value);
+		REQUIRE(value == 42);
+	}
+
+	SECTION("argumented_function2") {
+		auto& method = type->methods[3];
+		REQUIRE(method.name == "argumented_function2");
+
+		const char* prefix = "prefix";
+		int i = 6;
+		float f = 2.345f;
+		void* args[] = { &prefix, &i, &f };
+
+		const char* value = nullptr;
+		method.invoke_typed(&my_struct, args, &value);
+		REQUIRE(value != nullptr);
+		REQUIRE(std::string(value) == "prefix: 6 2.3");
+	}
+}
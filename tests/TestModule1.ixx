@@ -10,6 +10,8 @@ namespace Namespace {
 
 export struct MyBaseStruct { int health; };
 
+export enum class MyEnum : short { Zero, Two = 2, MinusOne = -1, AlsoTwo = 2 };
+
 export struct MyStruct : MyBaseStruct
 {
 	double damage;